@@ -0,0 +1,69 @@
+/// bench_spec_writers
+///
+/// Compare the time it takes to write the same spec with the yaml and json
+/// writers, and the size of the result (the `bytes` counter).
+///
+#include "yaml_spec_writer.hpp"
+#include "json_spec_writer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <memory>
+
+using namespace std;
+
+namespace {
+    // A made up set of classes, roughly the shape of the xAOD ones.
+    vector<spec_class> synthetic_classes(int n_classes) {
+        vector<spec_class> result;
+        for (int i = 0; i < n_classes; i++) {
+            spec_class c;
+            auto name = "Class" + to_string(i) + "_v1";
+            c.python_name = "xAOD." + name;
+            c.cpp_name = "xAOD::" + name;
+            c.library = "xAODSynthetic";
+            c.is_container = false;
+            c.include_file = "xAODSynthetic/versions/" + name + ".h";
+            c.also_behaves_like = {"xAOD.IParticle"};
+            c.enums.push_back(enum_info{"Kind", {{"first", 0}, {"second", 1}, {"third", 2}}});
+            for (int m_index = 0; m_index < 30; m_index++) {
+                spec_method m;
+                m.name = "method" + to_string(m_index);
+                m.return_type = "const ElementLink<DataVector<xAOD::" + name + ">>&";
+                m.arguments.push_back(spec_argument{"index", "unsigned int"});
+                m.arguments.push_back(spec_argument{"name", "std::string"});
+                c.methods.push_back(move(m));
+            }
+            result.push_back(move(c));
+        }
+        return result;
+    }
+
+    template <class W>
+    void write_classes(benchmark::State &state) {
+        auto classes = synthetic_classes(state.range(0));
+        size_t bytes = 0;
+        for (auto _ : state) {
+            ostringstream out;
+            W writer(out);
+            writer.write_collections({});
+            writer.begin_classes();
+            for (auto &&c : classes) {
+                writer.write_class(c);
+            }
+            writer.end_classes();
+            writer.write_config(spec_config{"22.2.107", {"PHYS", "PHYSLITE"}});
+            writer.finish("");
+            bytes = out.str().size();
+            benchmark::DoNotOptimize(bytes);
+        }
+        state.counters["bytes"] = bytes;
+        state.SetBytesProcessed(state.iterations() * bytes);
+    }
+}
+
+BENCHMARK_TEMPLATE(write_classes, yaml_spec_writer)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(write_classes, json_spec_writer)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,270 @@
+/// bench_type_helpers
+///
+/// Time the type name helpers that are called for every method of every class
+/// during a translation. Each benchmark runs over the whole corpus of type names
+/// below, so the `items_per_second` rate is in type names (or methods).
+///
+#include "type_helpers.hpp"
+#include "class_info.hpp"
+#include "memory_reflection_provider.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+
+using namespace std;
+
+namespace {
+    // Type names as they come out of ROOT for the xAOD classes, from the simple to the
+    // deeply nested.
+    const vector<string> _g_type_corpus = {
+        "int",
+        "unsigned int",
+        "unsigned long long",
+        "float",
+        "double",
+        "bool",
+        "const float",
+        "size_t",
+        "uint32_t",
+        "ULong64_t",
+        "string",
+        "std::string",
+        "const std::string&",
+        "xAOD::Jet_v1",
+        "const xAOD::Jet_v1*",
+        "xAOD::Muon_v1::Author",
+        "xAOD::EventInfo",
+        "xAOD::EventInfo_v1::EventFlagSubDet",
+        "xAOD::IParticle::FourMom_t",
+        "const xAOD::IParticle*",
+        "xAOD::TruthParticle_v1",
+        "xAOD::JetFourMom_t",
+        "ROOT::Math::PtEtaPhiM4D<double>",
+        "ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiM4D<double> >",
+        "TLorentzVector",
+        "vector<float>",
+        "vector<int>",
+        "vector<unsigned char>",
+        "vector<float>::size_type",
+        "std::vector<double>",
+        "const std::vector<float>&",
+        "vector<const xAOD::IParticle*>",
+        "vector<std::string>",
+        "vector<vector<float> >",
+        "vector<std::size_t, std::allocator<std::size_t> >",
+        "DataVector<xAOD::Jet_v1>",
+        "DataVector<xAOD::Jet_v1>::iterator",
+        "const DataVector<xAOD::TrackParticle_v1>*",
+        "DataVector<xAOD::SlowMuon_v1, DataModel_detail::NoBase>::PtrVector",
+        "const DataVector<xAOD::SlowMuon_v1, DataModel_detail::NoBase>::PtrVector",
+        "ElementLink<xAOD::JetContainer>",
+        "ElementLink<xAOD::TruthParticleContainer>",
+        "ElementLink<DataVector<xAOD::Jet_v1> >",
+        "const ElementLink<DataVector<xAOD::TrackParticle_v1> >&",
+        "ElementLink<DataVector<xAOD::CaloCluster_v1> >",
+        "vector<ElementLink<DataVector<xAOD::TrackParticle_v1> > >",
+        "const vector<ElementLink<DataVector<xAOD::TruthParticle_v1> > >&",
+        "vector<ElementLink<DataVector<xAOD::TruthVertex_v1> >,allocator<ElementLink<DataVector<xAOD::TruthVertex_v1> > > >",
+        "DataVector<xAOD::BTagging_v1,DataVector<xAOD::IParticle,DataModel_detail::NoBase> >",
+        "vector<vector<ElementLink<DataVector<xAOD::IParticle> > > >",
+        "std::vector<std::pair<unsigned int,std::vector<ElementLink<DataVector<xAOD::TrackParticle_v1> > > > >",
+        "xAOD::Vertex_v1::TrackParticleLinks_t",
+        "SG::AuxElement::Accessor<float>",
+        "SG::AuxElement::ConstAccessor<vector<ElementLink<DataVector<xAOD::Jet_v1> > > >",
+    };
+
+    // The typedefs and classes an xAOD release has loaded for the corpus, so typedef
+    // resolution finds real matches rather than missing on every name.
+    shared_ptr<memory_reflection_provider> corpus_reflection() {
+        auto result = make_shared<memory_reflection_provider>();
+        const vector<pair<string, string>> typedefs = {
+            {"xAOD::JetFourMom_t", "ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiM4D<double> >"},
+            {"xAOD::IParticle::FourMom_t", "TLorentzVector"},
+            {"xAOD::EventInfo", "xAOD::EventInfo_v1"},
+            {"xAOD::Jet", "xAOD::Jet_v1"},
+            {"xAOD::JetContainer", "DataVector<xAOD::Jet_v1>"},
+            {"xAOD::TruthParticle", "xAOD::TruthParticle_v1"},
+            {"xAOD::TruthParticleContainer", "DataVector<xAOD::TruthParticle_v1>"},
+            {"xAOD::TrackParticleContainer", "DataVector<xAOD::TrackParticle_v1>"},
+            {"xAOD::Vertex_v1::TrackParticleLinks_t", "vector<ElementLink<DataVector<xAOD::TrackParticle_v1> > >"},
+            {"std::string", "string"},
+            {"size_type", "unsigned long"},
+            {"vector<float>::size_type", "unsigned long"},
+        };
+        for (auto &&td : typedefs) {
+            result->add_typedef(td.first, td.second);
+        }
+        const vector<string> classes = {
+            "xAOD::Jet_v1",
+            "xAOD::EventInfo_v1",
+            "xAOD::TruthParticle_v1",
+            "xAOD::TrackParticle_v1",
+            "xAOD::IParticle",
+            "TLorentzVector",
+            "DataVector<xAOD::Jet_v1>",
+            "DataVector<xAOD::TruthParticle_v1>",
+            "DataVector<xAOD::TrackParticle_v1>",
+            "ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiM4D<double> >",
+            "vector<ElementLink<DataVector<xAOD::TrackParticle_v1> > >",
+        };
+        for (auto &&c_name : classes) {
+            reflected_class c;
+            c.name = c_name;
+            result->add_class(c);
+        }
+        return result;
+    }
+
+    // Known types for the method checks - everything in the corpus, once unqualified.
+    set<string> corpus_known_types() {
+        set<string> result;
+        for (auto &&t : _g_type_corpus) {
+            result.insert(unqualified_typename(parse_typename(t)));
+        }
+        return result;
+    }
+
+    // A method per corpus type, returning it and taking a couple of arguments.
+    vector<method_info> corpus_methods() {
+        vector<method_info> result;
+        for (size_t i = 0; i < _g_type_corpus.size(); i++) {
+            method_info m;
+            m.name = "method" + to_string(i);
+            m.return_type = _g_type_corpus[i];
+            auto other = _g_type_corpus[(i * 7) % _g_type_corpus.size()];
+            m.arguments.push_back(method_arg{"index", "unsigned int", "unsigned int"});
+            m.arguments.push_back(method_arg{"other", other, other});
+            result.push_back(m);
+        }
+        return result;
+    }
+
+    vector<typename_info> parsed_corpus() {
+        vector<typename_info> result;
+        for (auto &&t : _g_type_corpus) {
+            result.push_back(parse_typename(t));
+        }
+        return result;
+    }
+
+    void bm_parse_typename(benchmark::State &state) {
+        for (auto _ : state) {
+            for (auto &&t : _g_type_corpus) {
+                benchmark::DoNotOptimize(parse_typename(t));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * _g_type_corpus.size());
+    }
+
+    void bm_typename_cpp_string(benchmark::State &state) {
+        auto parsed = parsed_corpus();
+        for (auto _ : state) {
+            for (auto &&t : parsed) {
+                benchmark::DoNotOptimize(typename_cpp_string(t));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * parsed.size());
+    }
+
+    void bm_normalized_type_name(benchmark::State &state) {
+        for (auto _ : state) {
+            for (auto &&t : _g_type_corpus) {
+                benchmark::DoNotOptimize(normalized_type_name(t));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * _g_type_corpus.size());
+    }
+
+    // The typedefs come from an in-memory copy of a release (see `corpus_reflection`).
+    // The typedef map is built on the first call, outside the timing loop. `resolved` is
+    // how many of the corpus names resolve to something else.
+    void bm_resolve_typedef(benchmark::State &state) {
+        auto old_provider = set_reflection_provider(corpus_reflection());
+        clear_typedef_cache();
+
+        size_t resolved = 0;
+        for (auto &&t : _g_type_corpus) {
+            if (resolve_typedef(t) != t) {
+                resolved++;
+            }
+        }
+        for (auto _ : state) {
+            for (auto &&t : _g_type_corpus) {
+                benchmark::DoNotOptimize(resolve_typedef(t));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * _g_type_corpus.size());
+        state.counters["resolved"] = resolved;
+
+        set_reflection_provider(old_provider);
+        clear_typedef_cache();
+    }
+
+    void bm_referenced_types(benchmark::State &state) {
+        auto methods = corpus_methods();
+        for (auto _ : state) {
+            for (auto &&m : methods) {
+                benchmark::DoNotOptimize(referenced_types(m));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * methods.size());
+    }
+
+    // Without the cache every call re-parses each type; with it (as emission does) only
+    // the first pass does.
+    void bm_is_understood_method(benchmark::State &state) {
+        auto methods = corpus_methods();
+        auto known_types = corpus_known_types();
+        for (auto _ : state) {
+            for (auto &&m : methods) {
+                benchmark::DoNotOptimize(is_understood_method(m, known_types));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * methods.size());
+    }
+
+    void bm_is_understood_method_cached(benchmark::State &state) {
+        auto methods = corpus_methods();
+        auto known_types = corpus_known_types();
+        understood_type_cache cache(known_types);
+        for (auto _ : state) {
+            for (auto &&m : methods) {
+                benchmark::DoNotOptimize(is_understood_method(m, cache));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * methods.size());
+    }
+
+    // py_typename only takes links to DataVector's, so the rest of the corpus is skipped.
+    void bm_py_typename(benchmark::State &state) {
+        vector<string> corpus;
+        for (auto &&t : _g_type_corpus) {
+            try {
+                py_typename(t);
+                corpus.push_back(t);
+            } catch (const exception &) {
+            }
+        }
+        for (auto _ : state) {
+            for (auto &&t : corpus) {
+                benchmark::DoNotOptimize(py_typename(t));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * corpus.size());
+    }
+}
+
+BENCHMARK(bm_parse_typename);
+BENCHMARK(bm_typename_cpp_string);
+BENCHMARK(bm_normalized_type_name);
+BENCHMARK(bm_resolve_typedef);
+BENCHMARK(bm_referenced_types);
+BENCHMARK(bm_is_understood_method);
+BENCHMARK(bm_is_understood_method_cached);
+BENCHMARK(bm_py_typename);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,96 @@
+/// spec_diff
+///
+/// Compare two type specification files (yaml or json) and print what changed, or
+/// write a patch that turns the old one into the new one. With --apply, rebuild the
+/// new spec from the old one and a patch.
+///
+/// Does not need ROOT or the atlas software.
+///
+#include "spec_diff.hpp"
+#include "json_spec_writer.hpp"
+
+#include <argparse/argparse.hpp>
+#include "yaml-cpp/yaml.h"
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+
+namespace {
+    void write_node(ostream &out, const YAML::Node &node, const string &format) {
+        if (format == "json") {
+            write_json(out, node);
+        } else {
+            YAML::Emitter emitter(out);
+            emitter << node;
+        }
+        out << endl;
+    }
+}
+
+int main(int argc, char**argv) {
+    argparse::ArgumentParser program("spec_diff");
+
+    program.add_argument("old_spec")
+        .help("The old spec (or, with --apply, the spec the patch was made from)");
+
+    program.add_argument("new_spec")
+        .help("The new spec (or, with --apply, the patch)");
+
+    program.add_argument("--patch")
+        .help("Write a patch that turns the old spec into the new one to this file")
+        .default_value(string(""));
+
+    program.add_argument("--apply")
+        .help("Apply the patch (second argument) to the old spec and write the new spec to stdout")
+        .default_value(false)
+        .implicit_value(true)
+        .nargs(0);
+
+    program.add_argument("--format")
+        .help("Format of the patch or rebuilt spec: yaml or json")
+        .default_value(string("yaml"));
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const runtime_error& err) {
+        cerr << err.what() << endl;
+        cerr << program;
+        return 1;
+    }
+
+    auto format = program.get<string>("--format");
+    if (format != "yaml" && format != "json") {
+        cerr << "Unknown output format '" << format << "' - must be yaml or json." << endl;
+        cerr << program;
+        return 1;
+    }
+
+    try {
+        auto old_spec = YAML::LoadFile(program.get<string>("old_spec"));
+        auto second = YAML::LoadFile(program.get<string>("new_spec"));
+
+        if (program.get<bool>("--apply")) {
+            write_node(cout, apply_spec_patch(old_spec, second), format);
+            return 0;
+        }
+
+        auto diff = diff_specs(old_spec, second);
+        write_spec_diff_summary(cout, diff);
+
+        auto patch_path = program.get<string>("--patch");
+        if (patch_path.size() > 0) {
+            ofstream patch_out(patch_path);
+            write_node(patch_out, spec_patch(diff), format);
+            if (!patch_out) {
+                cerr << "ERROR: Unable to write patch file " << patch_path << endl;
+                return 1;
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "ERROR: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
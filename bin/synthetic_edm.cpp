@@ -0,0 +1,69 @@
+/// synthetic_edm
+///
+/// Write the headers and LinkDef.h for a made up, xAOD shaped, event data model
+/// with any number of classes. Run rootcling on them to get a dictionary to test
+/// generate_types against (the scale tests in CMakeLists.txt do this).
+///
+#include "synthetic_edm.hpp"
+
+#include <argparse/argparse.hpp>
+
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char**argv) {
+    argparse::ArgumentParser program("synthetic_edm");
+
+    program.add_argument("-o", "--output-dir")
+        .help("Directory to write the headers and LinkDef.h into")
+        .required();
+
+    program.add_argument("--classes")
+        .help("Number of classes")
+        .default_value(1000)
+        .scan<'i', int>();
+
+    program.add_argument("--inheritance-depth")
+        .help("Length of the chain of base classes each class inherits from")
+        .default_value(2)
+        .scan<'i', int>();
+
+    program.add_argument("--template-depth")
+        .help("How deeply the templated return types are nested")
+        .default_value(2)
+        .scan<'i', int>();
+
+    program.add_argument("--enums")
+        .help("Number of enums in each class")
+        .default_value(1)
+        .scan<'i', int>();
+
+    program.add_argument("--classes-per-header")
+        .help("Number of classes written to each header file")
+        .default_value(500)
+        .scan<'i', int>();
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const runtime_error& err) {
+        cerr << err.what() << endl;
+        cerr << program;
+        return 1;
+    }
+
+    synthetic_edm_config config;
+    config.n_classes = program.get<int>("--classes");
+    config.inheritance_depth = program.get<int>("--inheritance-depth");
+    config.template_depth = program.get<int>("--template-depth");
+    config.enums_per_class = program.get<int>("--enums");
+    config.classes_per_header = program.get<int>("--classes-per-header");
+
+    try {
+        write_synthetic_edm(config, program.get<string>("--output-dir"));
+    } catch (const exception &e) {
+        cerr << "ERROR: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
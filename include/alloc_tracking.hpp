@@ -0,0 +1,42 @@
+#ifndef __alloc_tracking__
+#define __alloc_tracking__
+
+#include <cstdint>
+
+// Heap allocation accounting. Only available when built with TRACK_ALLOCATIONS
+// (cmake -DTRACK_ALLOCATIONS=ON), which replaces the global operator new and
+// delete with versions that count every call. Otherwise all counts are zero.
+//
+// The phases of a run (see phase_timer.hpp) take the difference of the totals
+// at their start and end, so each phase gets the allocations made (on any thread)
+// while it ran.
+
+// Totals for the whole process since it started
+struct alloc_totals {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+
+    // As requested from operator new
+    uint64_t bytes_allocated = 0;
+
+    alloc_totals operator-(const alloc_totals &earlier) const;
+};
+
+// True if built with TRACK_ALLOCATIONS
+bool allocations_tracked();
+
+alloc_totals read_alloc_totals();
+
+// Bytes allocated with operator new and not yet freed (as malloc sized them), and
+// the most that has ever been at once.
+uint64_t tracked_live_bytes();
+uint64_t tracked_peak_live_bytes();
+
+// The most bytes live at once since the last reset (or the start). A reset starts
+// again from what is live now, and returns the peak it replaced. Give that back to
+// `raise_recent_peak_live_bytes` when done, so an enclosing window still sees it.
+uint64_t recent_peak_live_bytes();
+uint64_t reset_recent_peak_live_bytes();
+void raise_recent_peak_live_bytes(uint64_t bytes);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef __binary_spec_format__
+#define __binary_spec_format__
+
+#include <cstdint>
+
+// Layout of the binary type specification. It is written in native byte order, and
+// is made to be memory mapped and used in place:
+//
+//   header
+//   classes          - spec_bin_class[n_classes], in the order they were written
+//   class_index      - uint32_t[n_classes], indices into classes, sorted by cpp_name
+//   methods          - spec_bin_method[n_methods]
+//   arguments        - spec_bin_argument[n_arguments]
+//   enums            - spec_bin_enum[n_enums]
+//   enum_values      - spec_bin_enum_value[n_enum_values]
+//   string_lists     - uint32_t[n_string_list_entries], string ids
+//   strings          - string_table_size bytes of null terminated strings
+//
+// Strings are referenced by their byte offset into the string table. Offset 0 is
+// always the empty string. Everything else is referenced by (first, count) into the
+// right table. Only the classes are in the binary spec - collections, files and the
+// extra metadata are only written to the yaml and json specs.
+
+const char spec_bin_magic[8] = {'F', 'A', 'D', 'L', 'S', 'P', 'E', 'C'};
+const uint32_t spec_bin_version = 3;
+
+struct spec_bin_range {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct spec_bin_header {
+    char magic[8];
+    uint32_t version;
+
+    // The atlas release this was built from (a string id)
+    uint32_t atlas_release;
+
+    // Non-zero if inherited methods are only on the class that declares them
+    uint32_t declared_methods_only;
+
+    // Hashes of the spec contents and inputs (string ids)
+    uint32_t content_hash;
+    uint32_t inputs_hash;
+
+    // Byte offset and number of entries of each table
+    spec_bin_range classes;
+    spec_bin_range class_index;
+    spec_bin_range methods;
+    spec_bin_range arguments;
+    spec_bin_range enums;
+    spec_bin_range enum_values;
+    spec_bin_range string_lists;
+    spec_bin_range strings;
+};
+
+struct spec_bin_class {
+    uint32_t python_name;
+    uint32_t cpp_name;
+    uint32_t library;
+    uint32_t include_file;
+
+    // Non-zero if this is a container
+    uint32_t is_container;
+    uint32_t is_container_of_cpp;
+    uint32_t is_container_of_python;
+
+    // Into the string list table
+    spec_bin_range also_behaves_like;
+    spec_bin_range inherits_from;
+    spec_bin_range enums;
+    spec_bin_range methods;
+};
+
+struct spec_bin_method {
+    uint32_t name;
+    uint32_t return_type;
+    spec_bin_range arguments;
+    spec_bin_range parameter_arguments;
+    uint32_t param_helper;
+    uint32_t param_type_callback;
+};
+
+struct spec_bin_argument {
+    uint32_t name;
+    uint32_t type;
+};
+
+struct spec_bin_enum {
+    uint32_t name;
+    spec_bin_range values;
+};
+
+struct spec_bin_enum_value {
+    uint32_t name;
+    int32_t value;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __binary_spec_reader__
+#define __binary_spec_reader__
+
+#include "binary_spec_format.hpp"
+#include "spec_writer.hpp"
+
+#include <string>
+#include <string_view>
+
+// Look things up in a binary spec without reading all of it. The file is memory
+// mapped, and all the records returned point straight into the mapping - they are only
+// good as long as the reader is. Throws if the file can't be opened or isn't a binary spec.
+class binary_spec_reader {
+public:
+    binary_spec_reader(const std::string &path);
+    ~binary_spec_reader();
+
+    binary_spec_reader(const binary_spec_reader &) = delete;
+    binary_spec_reader &operator=(const binary_spec_reader &) = delete;
+
+    // A (first, count) view of one of the tables
+    template <class T>
+    struct records {
+        const T *first;
+        uint32_t count;
+
+        const T *begin() const { return first; }
+        const T *end() const { return first + count; }
+        size_t size() const { return count; }
+        const T &operator[](size_t i) const { return first[i]; }
+    };
+
+    // A string from the string table
+    std::string_view string_at(uint32_t id) const;
+
+    std::string_view atlas_release() const;
+    bool declared_methods_only() const;
+    std::string_view content_hash() const;
+    std::string_view inputs_hash() const;
+
+    // All classes, in the order they were written
+    records<spec_bin_class> classes() const;
+
+    // Find a class by its C++ name (binary search of the class index). Returns
+    // nullptr if it is not there.
+    const spec_bin_class *find_class(std::string_view cpp_name) const;
+
+    // The parts of a class or method
+    records<spec_bin_method> methods(const spec_bin_class &c) const;
+    records<spec_bin_enum> enums(const spec_bin_class &c) const;
+    records<spec_bin_enum_value> values(const spec_bin_enum &e) const;
+    records<uint32_t> also_behaves_like(const spec_bin_class &c) const;
+    records<uint32_t> inherits_from(const spec_bin_class &c) const;
+    records<spec_bin_argument> arguments(const spec_bin_method &m) const;
+    records<spec_bin_argument> parameter_arguments(const spec_bin_method &m) const;
+
+    // Unpack a class completely
+    spec_class read_class(const spec_bin_class &c) const;
+
+private:
+    template <class T>
+    records<T> table(const spec_bin_range &table_range) const;
+    template <class T>
+    records<T> sub_range(const records<T> &all, const spec_bin_range &r) const;
+
+    const char *m_data;
+    size_t m_size;
+    const spec_bin_header *m_header;
+};
+
+#endif
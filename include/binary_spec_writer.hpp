@@ -0,0 +1,56 @@
+#ifndef __binary_spec_writer__
+#define __binary_spec_writer__
+
+#include "spec_writer.hpp"
+#include "binary_spec_format.hpp"
+
+#include <ostream>
+#include <unordered_map>
+
+// Write the classes of the spec in the binary format (see binary_spec_format.hpp).
+// The class index can only be built once every class is known, so the (fixed size)
+// records are kept until `finish`, and then the whole file is written.
+class binary_spec_writer : public spec_writer {
+public:
+    binary_spec_writer(std::ostream &out);
+
+    // Collections and files are not part of the binary spec.
+    void write_collections(const std::vector<spec_collection> &) override {}
+
+    void begin_classes() override {}
+    void write_class(const spec_class &c) override;
+    void end_classes() override {}
+
+    void begin_files() override {}
+    void write_file(const spec_file &) override {}
+    void end_files() override {}
+
+    void write_config(const spec_config &config) override;
+
+    // The extra metadata is not added to the binary spec.
+    void finish(const std::string &extra_metadata_path) override;
+
+private:
+    // Return the id of a string in the string table, adding it if needed
+    uint32_t string_id(const std::string &s);
+    spec_bin_range add_arguments(const std::vector<spec_argument> &arguments);
+    spec_bin_range add_string_list(const std::vector<std::string> &strings);
+
+    std::ostream &m_out;
+    uint32_t m_atlas_release;
+    bool m_declared_methods_only;
+    uint32_t m_content_hash;
+    uint32_t m_inputs_hash;
+
+    std::vector<spec_bin_class> m_classes;
+    std::vector<spec_bin_method> m_methods;
+    std::vector<spec_bin_argument> m_arguments;
+    std::vector<spec_bin_enum> m_enums;
+    std::vector<spec_bin_enum_value> m_enum_values;
+    std::vector<uint32_t> m_string_lists;
+
+    std::string m_strings;
+    std::unordered_map<std::string, uint32_t> m_string_ids;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <map>
+#include <set>
 
 struct pointer_info {
     // True if the pointer is const -
@@ -64,6 +66,10 @@ struct method_info {
     // What should be the parameter method callback to process this if
     // template arguments are present?
     std::string param_method_callback;
+
+    // The class that declares this method (as ROOT names it). Blank for the
+    // methods we add by hand.
+    std::string declaring_class;
 };
 
 struct enum_info {
@@ -99,6 +105,11 @@ struct class_info {
 
     // The list of enums
     std::vector<enum_info> enums;
+
+    // Filled by `classify_containers`: can this class be iterated over, and
+    // if so, what type does it contain.
+    bool is_container = false;
+    typename_info container_type;
 };
 
 std::ostream& operator <<(std::ostream& stream, const class_info& ci);
@@ -116,4 +127,14 @@ std::vector<std::string> referenced_types(const typename_info &a_info);
 bool has_methods(const class_info &ci, const std::vector<std::string> &names);
 std::vector<method_info> get_method(const class_info &ci, const std::string &method);
 
+// Return the first method of a given name, or nullptr if there is none. No copies are made.
+const method_info *find_method(const class_info &ci, const std::string &method);
+
+// The closest ancestors of a class that are in `emitted`, looking through any
+// ancestors that are not. Every emitted ancestor, at any distance, is added to
+// `all_emitted`. Ancestors that are not in `classes` are ignored.
+std::vector<std::string> nearest_emitted_ancestors(const class_info &ci,
+    const std::map<std::string, const class_info*> &classes, const std::set<std::string> &emitted,
+    std::set<std::string> &all_emitted);
+
 #endif
@@ -56,7 +56,7 @@ struct collection_extra {
 
 
 // Hardcode the config for ATLAS R21
-std::map<std::string, collection_extra> _g_collection_config {
+inline std::map<std::string, collection_extra> _g_collection_config {
     {"Jets", {"Jets", {
         {"collection", "Optional[str]", "None"},
         {"calibrate", "Optional[bool]", "True"},
@@ -0,0 +1,148 @@
+#ifndef __compressing_streambuf__
+#define __compressing_streambuf__
+
+#include <streambuf>
+#include <ostream>
+#include <string>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+enum class spec_compression {
+    none,
+    gzip,
+    // Only if zstd was found when this was built - see `compression_available`.
+    zstd
+};
+
+// Was support for this compression built in?
+bool compression_available(spec_compression method);
+
+// File extension to add for the compression (".gz", etc.), or blank.
+std::string compression_file_extension(spec_compression method);
+
+// The number of chunks that may be compressed at once, shared by every stream that
+// holds it (e.g. all the files of a sharded output).
+class compression_thread_limit {
+public:
+    // 0 (or less) means one per hardware thread
+    explicit compression_thread_limit(int threads = 0);
+
+    int threads() const { return m_threads; }
+
+    // Wait for a free thread, and give it back when done
+    void acquire();
+    void release();
+
+private:
+    int m_threads;
+    int m_free;
+    std::mutex m_lock;
+    std::condition_variable m_freed;
+};
+
+// Compress everything written, and pass it on to another stream.
+//
+// The data is cut into chunks, and each chunk is compressed on its own thread and
+// written as a complete gzip member (or zstd frame). Concatenated members are a valid
+// gzip (zstd) file, so any normal tool can decompress the result. Up to `threads` chunks
+// are compressed at once while the caller keeps writing. Streams given the same
+// `compression_thread_limit` share its threads between them.
+//
+// Everything is only guaranteed to be written to the output once `finish` is called
+// (the destructor calls it too). `sync` (e.g. std::endl) does not force out a partial chunk.
+class compressing_streambuf : public std::streambuf {
+public:
+    compressing_streambuf(std::ostream &out, spec_compression method, int threads = 0,
+        size_t chunk_size = 1 << 20);
+    compressing_streambuf(std::ostream &out, spec_compression method,
+        std::shared_ptr<compression_thread_limit> limit, size_t chunk_size = 1 << 20);
+    ~compressing_streambuf();
+
+    compressing_streambuf(const compressing_streambuf &) = delete;
+    compressing_streambuf &operator=(const compressing_streambuf &) = delete;
+
+    // Compress and write anything that is left, and wait for it all to be written.
+    void finish();
+
+    // Totals so far
+    size_t bytes_in() const { return m_bytes_in; }
+    size_t bytes_out() const { return m_bytes_out; }
+
+    // Time spent compressing (summed over all threads), and time the writer had to
+    // wait for the compression to finish.
+    double compress_seconds() const { return m_compress_seconds; }
+    double wait_seconds() const { return m_wait_seconds; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    struct compressed_chunk {
+        std::string data;
+        double seconds;
+    };
+
+    // Move what has been written into the chunk buffer, sending full chunks off.
+    void drain_put_area();
+    void append(const char *s, size_t n);
+
+    // Send the current buffer off to be compressed.
+    void submit_chunk(bool even_if_empty = false);
+
+    // Write out the oldest chunk in flight, waiting for it if needed.
+    void write_oldest();
+
+    std::ostream &m_out;
+    spec_compression m_method;
+    std::shared_ptr<compression_thread_limit> m_limit;
+    size_t m_max_in_flight;
+    size_t m_chunk_size;
+
+    std::vector<char> m_put_area;
+    std::string m_buffer;
+    std::deque<std::future<compressed_chunk>> m_in_flight;
+    bool m_finished;
+
+    size_t m_bytes_in;
+    size_t m_bytes_out;
+    double m_compress_seconds;
+    double m_wait_seconds;
+};
+
+// Totals over one or more compressed streams
+struct compression_stats {
+    size_t bytes_in = 0;
+    size_t bytes_out = 0;
+    double compress_seconds = 0;
+    double wait_seconds = 0;
+
+    void add(const compressing_streambuf &buf);
+};
+
+// A stream that compresses into another stream. Call `finish` when done.
+class compressing_ostream : public std::ostream {
+public:
+    compressing_ostream(std::ostream &out, spec_compression method, int threads = 0)
+        : std::ostream(nullptr), m_buf(out, method, threads)
+    {
+        rdbuf(&m_buf);
+    }
+    compressing_ostream(std::ostream &out, spec_compression method, std::shared_ptr<compression_thread_limit> limit)
+        : std::ostream(nullptr), m_buf(out, method, limit)
+    {
+        rdbuf(&m_buf);
+    }
+
+    void finish() { m_buf.finish(); }
+    const compressing_streambuf &compressor() const { return m_buf; }
+
+private:
+    compressing_streambuf m_buf;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __content_hash__
+#define __content_hash__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 64 bit FNV-1a hash. Strings are added with their length, so ("ab", "c") and
+// ("a", "bc") hash differently.
+class fnv1a_hash {
+public:
+    fnv1a_hash();
+
+    void add_bytes(const void *data, size_t size);
+    void add(const std::string &s);
+    void add(const std::vector<std::string> &strings);
+    void add(uint64_t v);
+
+    uint64_t value() const { return m_hash; }
+
+    // The hash as 16 hex digits
+    std::string hex() const;
+
+private:
+    uint64_t m_hash;
+};
+
+// Hash the contents of a file. A missing file hashes differently from an empty one.
+void add_file_contents(fnv1a_hash &hash, const std::string &path);
+
+#endif
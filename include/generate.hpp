@@ -0,0 +1,100 @@
+#ifndef __generate__
+#define __generate__
+
+#include "spec_writer.hpp"
+#include "sharded_spec_writer.hpp"
+#include "compressing_streambuf.hpp"
+#include "helper_files.hpp"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Everything needed to run a generation of the type specification.
+struct generate_config {
+    // Classes to start the translation from. Everything they reference is
+    // translated as well.
+    std::vector<std::string> classes;
+
+    // Shared libraries to load before translation starts.
+    std::vector<std::string> libraries;
+
+    // The ATLAS release ("xx.yy.zz"). If blank, the `AtlasVersion`
+    // environment variable is used.
+    std::string atlas_release;
+
+    // Where to find the metadata files that are emitted with the spec.
+    std::string metadata_prefix = "metadata/";
+
+    // Discovery follows references from the seed classes at most this many
+    // hops. Negative means no limit.
+    int max_discovery_depth = -1;
+
+    // If not empty, discovery only follows classes whose outer most namespace is
+    // listed here ("::" for the global namespace). Seed classes are always translated.
+    std::vector<std::string> discovery_namespaces;
+
+    // If not empty, discovery only keeps classes that come from one of these
+    // libraries (e.g. "xAODJet"). Classes with no library (like vector<float>) are kept.
+    std::vector<std::string> discovery_libraries;
+
+    // Format of the spec that is written out.
+    spec_format format = spec_format::yaml;
+
+    // Write each method only on the class that declares it, rather than repeating
+    // inherited methods on every derived class. Classes list their bases in `inherits_from`.
+    bool declared_methods_only = false;
+
+    // Build the class records on this many threads (0 for one per core). They are still
+    // written in the same order, so the output does not depend on this.
+    int emit_threads = 1;
+
+    // If not blank, the spec is written as shards into this directory (see
+    // sharded_spec_writer.hpp) rather than to the output stream.
+    std::string output_directory;
+    spec_shard_by shard_by = spec_shard_by::library;
+
+    // How the helper files are written (see helper_files.hpp)
+    helper_file_options helper_files;
+
+    // If not blank, read the class information from this file (see
+    // memory_reflection_provider.hpp) rather than from ROOT. No libraries are loaded.
+    std::string reflection_file;
+
+    // If not blank, write every class, typedef and include file that was looked up to
+    // this file, so the run can be replayed with `reflection_file`.
+    std::string record_reflection_file;
+
+    // Print the wall and CPU time, and the memory use (RSS, heap) at the end, of each phase
+    // to std::cerr at the end of the run, and, if not blank, write them as json to
+    // `timings_file` (see phase_timer.hpp).
+    bool report_timings = false;
+    std::string timings_file;
+
+    // Print the operation counts (see run_stats.hpp) and the calls into ROOT (see
+    // root_calls.hpp) to std::cerr at the end of the run, and, if not blank, write them
+    // as json to `stats_file` (`{"counters": {...}, "root_calls": {...}}`).
+    bool report_stats = false;
+    std::string stats_file;
+
+    // If more than zero, time the translation of each class, and print a histogram of
+    // the times and this many of the slowest classes to std::cerr at the end.
+    int slow_classes = 0;
+
+    // If not blank, write a Chrome trace-event file here with a span for each phase,
+    // class translation, library load and helper file (see trace.hpp).
+    std::string trace_file;
+
+    // Compress the output as it is written, using this many threads (0 for one per core).
+    spec_compression compression = spec_compression::none;
+    int compression_threads = 0;
+};
+
+// Run discovery, pruning and emission for the given configuration, and write the
+// type specification to `out` (in the configured format), or to the output directory. Error and info messages are written to std::cerr.
+//
+// ROOT must already be initialized (see `create_root_app`). This can be called several
+// times in the same process - libraries that are already loaded are not reloaded.
+void generate_spec(const generate_config &config, std::ostream &out);
+
+#endif
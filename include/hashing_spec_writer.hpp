@@ -0,0 +1,37 @@
+#ifndef __hashing_spec_writer__
+#define __hashing_spec_writer__
+
+#include "spec_writer.hpp"
+#include "content_hash.hpp"
+
+// Pass everything through to another writer, hashing the collections, classes, files
+// and the extra metadata on the way. The hash goes into the config block (`content_hash`)
+// when it is written. The hash is of the content, not the bytes, so it is the same for
+// every output format.
+class hashing_spec_writer : public spec_writer {
+public:
+    hashing_spec_writer(spec_writer &out, const std::string &extra_metadata_path);
+
+    void write_collections(const std::vector<spec_collection> &collections) override;
+
+    void begin_classes() override;
+    void write_class(const spec_class &c) override;
+    void end_classes() override;
+
+    void begin_files() override;
+    void write_file(const spec_file &f) override;
+    void end_files() override;
+
+    void write_config(const spec_config &config) override;
+
+    void finish(const std::string &extra_metadata_path) override;
+
+    // The hash of everything written so far
+    std::string content_hash() const { return m_hash.hex(); }
+
+private:
+    spec_writer &m_out;
+    fnv1a_hash m_hash;
+};
+
+#endif
@@ -1,10 +1,39 @@
 #ifndef __helper_files__
 #define __helper_files__
 
-#include "yaml-cpp/yaml.h"
+#include "spec_writer.hpp"
 #include "metadata_file_finder.hpp"
 
+#include <map>
+
+// Where each of the helper files is read from
+std::vector<std::string> helper_file_paths(const metadata_file_finder &finder);
+
+// How the helper files are written
+struct helper_file_options {
+    // Each file as one block of text, with a hash, rather than line by line.
+    bool as_text = false;
+
+    // Files whose hash matches the file of the same name in this spec (path to a
+    // yaml or json spec) are written as a reference to it (see `spec_reference_id`).
+    // Implies `as_text`.
+    std::string reference_spec;
+};
+
+// The text of a file (each line followed by a newline), and its hash. Blank lines at the
+// end are dropped, as a yaml text block does not keep them.
+std::string helper_file_text(const std::vector<std::string> &lines);
+std::string helper_file_hash(const std::vector<std::string> &lines);
+
+// Hash of each file in a spec, by file name
+std::map<std::string, std::string> spec_file_hashes(const std::string &spec_path);
+
+// How files written as a reference name the spec they refer to: its content hash, or
+// if it has none, its file name (without the directory).
+std::string spec_reference_id(const std::string &spec_path);
+
 // Emit the files
-void emit_helper_files (YAML::Emitter &out, const metadata_file_finder &finder);
+void emit_helper_files (spec_writer &out, const metadata_file_finder &finder,
+    const helper_file_options &options = helper_file_options());
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef __json_spec_writer__
+#define __json_spec_writer__
+
+#include "spec_writer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <ostream>
+
+// Write the spec as (compact) json. Same logical layout as the yaml spec, so
+// a reader can pick either one. Everything is written straight to the output stream.
+class json_spec_writer : public spec_writer {
+public:
+    json_spec_writer(std::ostream &out);
+
+    void write_collections(const std::vector<spec_collection> &collections) override;
+
+    void begin_classes() override;
+    void write_class(const spec_class &c) override;
+    void end_classes() override;
+
+    void begin_files() override;
+    void write_file(const spec_file &f) override;
+    void end_files() override;
+
+    void write_config(const spec_config &config) override;
+
+    // The extra metadata file is yaml - it is converted to json as it is appended.
+    void finish(const std::string &extra_metadata_path) override;
+
+private:
+    // Write the key of the next top level item
+    void top_level_key(const std::string &name);
+
+    std::ostream &m_out;
+    bool m_first_top_level;
+    bool m_first_item;
+};
+
+// Write a string as a quoted and escaped json string
+void write_json_string(std::ostream &out, const std::string &s);
+
+// Write out a yaml node as json. Plain scalars that look like json numbers, booleans or
+// null are written as such; everything else is written as a string.
+void write_json(std::ostream &out, const YAML::Node &node);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef __memory_reflection_provider__
+#define __memory_reflection_provider__
+
+#include "reflection_provider.hpp"
+
+#include <ostream>
+#include <set>
+#include <mutex>
+
+// Class information held in memory, filled by hand or from a yaml file. Lookups are
+// deterministic, and nothing needs ROOT or a release.
+//
+// The file looks like:
+//
+//   classes:
+//     - name: xAOD::Jet_v1
+//       library: libxAODJetDict.so
+//       declaration_file: xAODJet/versions/Jet_v1.h
+//       bases: [xAOD::IParticle]
+//       methods:
+//         - {name: pt, return_type: double, declaring_class: xAOD::Jet_v1, arguments: []}
+//       enums:
+//         - {name: Kind, values: [{name: first, value: 0}]}
+//   aliases: {xAOD::JetContainer: DataVector<xAOD::Jet_v1>}
+//   typedefs: {xAOD::JetContainer: DataVector<xAOD::Jet_v1>}
+//   include_files: [xAODJet/JetContainer.h]
+//
+// Method arguments are `{name, type, full_type}` (the raw and full type names).
+class memory_reflection_provider : public reflection_provider {
+public:
+    memory_reflection_provider() {}
+
+    // Load everything in the file (see above), replacing what is already there.
+    explicit memory_reflection_provider(const std::string &path);
+
+    // Add things by hand. Classes with the same name are replaced.
+    void add_class(const reflected_class &c);
+    // `name` is looked up as `class_name`
+    void add_alias(const std::string &name, const std::string &class_name);
+    void add_typedef(const std::string &name, const std::string &type);
+    void add_include_file(const std::string &include_path);
+
+    // Write everything out in the file format above.
+    void write(std::ostream &out) const;
+
+    // Libraries do not need loading
+    int load_library(const std::string &) override { return 0; }
+
+    // Exact names, then aliases, then typedefs are tried.
+    std::string class_name(const std::string &name) override;
+    reflected_class get_class(const std::string &name) override;
+    std::string class_library(const std::string &name) override;
+    std::vector<std::string> public_bases(const std::string &name) override;
+    std::map<std::string, std::string> typedefs() override { return m_typedefs; }
+    std::vector<std::string> loaded_classes() override;
+    bool include_file_exists(const std::string &include_path) override;
+
+private:
+    // `visited` holds the names already tried, so a typedef loop ends
+    std::string class_name(const std::string &name, std::set<std::string> &visited);
+
+    std::map<std::string, reflected_class> m_classes;
+    std::map<std::string, std::string> m_aliases;
+    std::map<std::string, std::string> m_typedefs;
+    std::set<std::string> m_include_files;
+};
+
+// Passes everything through to another provider, and keeps a copy of every class,
+// typedef and include file it was asked about. Write out `recorded` to replay the
+// run later with a memory_reflection_provider. Safe to call from several threads.
+class recording_reflection_provider : public reflection_provider {
+public:
+    recording_reflection_provider(std::shared_ptr<reflection_provider> inner);
+
+    const memory_reflection_provider &recorded() const { return m_recorded; }
+
+    int load_library(const std::string &name) override;
+    std::string class_name(const std::string &name) override;
+    reflected_class get_class(const std::string &name) override;
+    std::string class_library(const std::string &name) override;
+    std::vector<std::string> public_bases(const std::string &name) override;
+    std::map<std::string, std::string> typedefs() override;
+    std::vector<std::string> loaded_classes() override;
+    bool include_file_exists(const std::string &include_path) override;
+
+private:
+    // Make sure the recorded copy has this class
+    void record_class(const std::string &name);
+
+    std::shared_ptr<reflection_provider> m_inner;
+    memory_reflection_provider m_recorded;
+    std::set<std::string> m_recorded_classes;
+    std::recursive_mutex m_lock;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __memory_usage__
+#define __memory_usage__
+
+#include <cstdint>
+
+// The memory used by the process at one moment. Anything that can't be read on
+// this platform is zero.
+struct memory_sample {
+    // Resident set size now, and the most it has been since the process started
+    uint64_t rss_bytes = 0;
+    uint64_t peak_rss_bytes = 0;
+
+    // Bytes handed out by malloc and not yet freed (includes ROOT's own allocations)
+    uint64_t heap_in_use_bytes = 0;
+};
+
+memory_sample sample_memory();
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __phase_timer__
+#define __phase_timer__
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include <ctime>
+
+#include "trace.hpp"
+#include "alloc_tracking.hpp"
+#include "memory_usage.hpp"
+
+// Time spent in one phase of a run
+struct phase_timing {
+    std::string name;
+    double wall_seconds = 0.0;
+
+    // Process CPU time, so it counts all threads
+    double cpu_seconds = 0.0;
+
+    // Heap allocations made during the phase (zero unless built with TRACK_ALLOCATIONS)
+    uint64_t allocations = 0;
+    uint64_t bytes_allocated = 0;
+
+    // Memory sampled when the phase ended, and how much the resident size grew during it
+    memory_sample memory;
+    int64_t rss_change_bytes = 0;
+
+    // Most bytes live at once from operator new while the phase ran (for the total, over
+    // the whole process). Zero unless built with TRACK_ALLOCATIONS.
+    uint64_t peak_live_bytes = 0;
+};
+
+// Records the wall and CPU time, and the memory at the end, of a sequence of
+// phases. Phases are timed with `scoped_phase`, and are listed in the order they
+// finished. A phase run twice is listed twice.
+class phase_timer {
+public:
+    phase_timer();
+
+    const std::vector<phase_timing> &phases() const { return m_phases; }
+
+    // Everything since the timer was created
+    phase_timing total() const;
+
+private:
+    friend class scoped_phase;
+
+    std::chrono::steady_clock::time_point m_start_wall;
+    std::clock_t m_start_cpu;
+    alloc_totals m_start_allocs;
+    memory_sample m_start_memory;
+    std::vector<phase_timing> m_phases;
+};
+
+// Times a phase from construction to destruction. The phase is also a span in
+// the active trace, if there is one.
+class scoped_phase {
+public:
+    scoped_phase(phase_timer &timer, const std::string &name);
+    ~scoped_phase();
+
+    scoped_phase(const scoped_phase &) = delete;
+    scoped_phase &operator=(const scoped_phase &) = delete;
+
+private:
+    phase_timer &m_timer;
+    std::string m_name;
+    std::chrono::steady_clock::time_point m_start_wall;
+    std::clock_t m_start_cpu;
+    alloc_totals m_start_allocs;
+    memory_sample m_start_memory;
+    uint64_t m_outer_peak_live_bytes;
+    scoped_trace_span m_span;
+};
+
+// A table of the phases and the total, one line per phase, with the memory at the end of
+// each. Allocations are only shown if they are tracked.
+void write_phase_table(std::ostream &out, const phase_timer &timer);
+
+// The phases and the total as json:
+//   {"phases": [{"name": ..., "wall_seconds": ..., "cpu_seconds": ...}, ...], "total": {...}}
+// and "rss_bytes", "rss_change_bytes", "peak_rss_bytes" and "heap_in_use_bytes". With
+// allocations tracked, each entry also has "allocations", "bytes_allocated" and "peak_live_bytes".
+void write_phase_json(std::ostream &out, const phase_timer &timer);
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __reflection_provider__
+#define __reflection_provider__
+
+#include "class_info.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+// Everything the translation needs to know about a class from the type system.
+struct reflected_class {
+    // Name as the type system spells it
+    std::string name;
+
+    // The shared library (as the type system gives it, e.g. "libxAODJetDict.so"), and the
+    // header the class is declared in. Blank if not known.
+    std::string library;
+    std::string declaration_file;
+
+    // Classes directly, and publicly, inherited from
+    std::vector<std::string> public_bases;
+
+    // All public methods, including inherited ones, in the order the type system lists
+    // them. The return type is as the type system gives it ("void" for nothing), and
+    // argument names can be blank.
+    std::vector<method_info> methods;
+
+    std::vector<enum_info> enums;
+};
+
+// Where class, typedef and library information comes from. Normally that is ROOT (see
+// root_reflection_provider.hpp), but it can also be an in-memory copy (see
+// memory_reflection_provider.hpp) so the pipeline can run without a release.
+class reflection_provider {
+public:
+    virtual ~reflection_provider() {}
+
+    // Load a shared library. Returns a negative number on failure.
+    virtual int load_library(const std::string &name) = 0;
+
+    // The name of the class as the type system knows it (which may differ in spacing,
+    // or because `name` is a typedef), or blank if it is not known as a class.
+    virtual std::string class_name(const std::string &name) = 0;
+
+    // Everything about a class. `name` should be one `class_name` returned. A class that
+    // is not known gives an empty record (blank name).
+    virtual reflected_class get_class(const std::string &name) = 0;
+
+    // The shared library of a class (as `get_class` gives it), without fetching anything
+    // else. Blank if not known.
+    virtual std::string class_library(const std::string &name) = 0;
+
+    // Classes directly, and publicly, inherited from. Empty if the class is not known.
+    virtual std::vector<std::string> public_bases(const std::string &name) = 0;
+
+    // All known typedefs, typedef name to the full type name
+    virtual std::map<std::string, std::string> typedefs() = 0;
+
+    // All the classes the type system has loaded
+    virtual std::vector<std::string> loaded_classes() = 0;
+
+    // Does this include file (e.g. "xAODJet/JetContainer.h") exist in the release?
+    virtual bool include_file_exists(const std::string &include_path) = 0;
+};
+
+// The provider the translation uses. ROOT, unless something else has been set.
+reflection_provider &reflection();
+
+// The provider in use, as a pointer (e.g. to wrap it in another provider).
+std::shared_ptr<reflection_provider> current_reflection_provider();
+
+// Use a different provider, returning the one that was in use.
+std::shared_ptr<reflection_provider> set_reflection_provider(std::shared_ptr<reflection_provider> provider);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __root_calls__
+#define __root_calls__
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+// Every call we make into ROOT goes through the functions below, which count
+// the calls and the time spent in them. That separates ROOT's time (loading
+// dictionaries, autoparsing) from our own.
+enum class root_call {
+    get_class,                      // TClass::GetClass
+    get_list_of_all_public_methods, // TClass::GetListOfAllPublicMethods
+    get_list_of_bases,              // TClass::GetListOfBases
+    get_list_of_enums,              // TClass::GetListOfEnums
+    get_list_of_types,              // TROOT::GetListOfTypes
+    get_list_of_classes,            // TROOT::GetListOfClasses
+    load,                           // TSystem::Load
+    expand_path_name,               // TSystem::ExpandPathName
+    access_path_name,               // TSystem::AccessPathName
+    n_calls
+};
+
+struct root_call_stats {
+    uint64_t calls = 0;
+    double seconds = 0.0;
+};
+
+// The totals for every entry point at one moment
+struct root_call_totals {
+    std::array<root_call_stats, static_cast<size_t>(root_call::n_calls)> values{};
+
+    const root_call_stats &operator[](root_call c) const { return values[static_cast<size_t>(c)]; }
+
+    // The totals between two snapshots
+    root_call_totals operator-(const root_call_totals &earlier) const;
+};
+
+root_call_totals read_root_call_totals();
+
+// Name used in the reports (e.g. "TClass::GetClass")
+std::string root_call_name(root_call c);
+
+// One line per entry point that was called, most time first
+void write_root_call_table(std::ostream &out, const root_call_totals &totals);
+
+// `{"TClass::GetClass": {"calls": n, "seconds": s}, ...}`
+void write_root_call_json(std::ostream &out, const root_call_totals &totals);
+
+class TClass;
+class TCollection;
+
+// The wrappers. They behave just like the ROOT calls they are named for.
+TClass *root_get_class(const std::string &name);
+const TCollection *root_list_of_all_public_methods(TClass *c);
+const TCollection *root_list_of_bases(TClass *c);
+const TCollection *root_list_of_enums(TClass *c);
+const TCollection *root_list_of_types();
+const TCollection *root_list_of_classes();
+int root_load_library(const std::string &name);
+std::string root_expand_path_name(const std::string &path);
+bool root_file_exists(const std::string &path);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __root_reflection_provider__
+#define __root_reflection_provider__
+
+#include "reflection_provider.hpp"
+
+// Class information straight from ROOT's type system.
+class root_reflection_provider : public reflection_provider {
+public:
+    int load_library(const std::string &name) override;
+    std::string class_name(const std::string &name) override;
+    reflected_class get_class(const std::string &name) override;
+    std::string class_library(const std::string &name) override;
+    std::vector<std::string> public_bases(const std::string &name) override;
+    std::map<std::string, std::string> typedefs() override;
+    std::vector<std::string> loaded_classes() override;
+
+    // Looks under $ROOTCOREDIR/include
+    bool include_file_exists(const std::string &include_path) override;
+};
+
+// Return a TClass, but skip internal classes.
+class TClass;
+TClass *get_tclass(const std::string &name);
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef __run_stats__
+#define __run_stats__
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+// Counts of the expensive operations in a run. They are always on: counting is a
+// relaxed atomic add.
+enum class run_counter {
+    tclass_lookups,            // TClass::GetClass calls
+    tclass_lookup_misses,      // ... that found nothing
+    parse_typename_calls,
+    typedef_resolutions,       // resolve_typedef calls
+    include_file_checks,       // include files looked for on disk
+    classes_translated,        // translate_class calls
+    methods_translated,
+    enums_translated,
+    discovery_queue_pushes,
+    discovery_duplicates,      // queued classes that were already done when reached
+    prune_passes,
+    bytes_emitted,             // spec bytes written, before any compression
+    n_counters
+};
+
+namespace run_stats_detail {
+    extern std::array<std::atomic<uint64_t>, static_cast<size_t>(run_counter::n_counters)> counters;
+}
+
+inline void add_count(run_counter c, uint64_t n = 1)
+{
+    run_stats_detail::counters[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+}
+
+// The value of every counter at one moment
+struct run_counters {
+    std::array<uint64_t, static_cast<size_t>(run_counter::n_counters)> values{};
+
+    uint64_t operator[](run_counter c) const { return values[static_cast<size_t>(c)]; }
+
+    // The counts between two snapshots
+    run_counters operator-(const run_counters &earlier) const;
+};
+
+run_counters read_run_counters();
+
+// Name used in the reports (e.g. "tclass_lookups")
+std::string run_counter_name(run_counter c);
+
+// One `name: value` line per counter
+void write_run_counters(std::ostream &out, const run_counters &counters);
+
+// `{"name": value, ...}`
+void write_run_counters_json(std::ostream &out, const run_counters &counters);
+
+// Passes everything through to another stream, counting the bytes as `bytes_emitted`.
+// Output is buffered, and counted as each buffer is passed on. Flush (or destroy) it
+// before using the other stream directly.
+class counting_streambuf : public std::streambuf {
+public:
+    counting_streambuf(std::ostream &out);
+    ~counting_streambuf();
+
+protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+private:
+    // Pass on what is in the buffer, and empty it
+    bool flush_buffer();
+
+    std::ostream &m_out;
+    std::vector<char> m_buffer;
+};
+
+class counting_ostream : public std::ostream {
+public:
+    counting_ostream(std::ostream &out)
+        : std::ostream(nullptr), m_buf(out)
+    {
+        rdbuf(&m_buf);
+    }
+
+private:
+    counting_streambuf m_buf;
+};
+
+#endif
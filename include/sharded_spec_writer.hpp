@@ -0,0 +1,97 @@
+#ifndef __sharded_spec_writer__
+#define __sharded_spec_writer__
+
+#include "spec_writer.hpp"
+#include "compressing_streambuf.hpp"
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <memory>
+
+// How classes are split into shards
+enum class spec_shard_by {
+    // The library the class comes from. Classes without a library go by namespace.
+    library,
+    // The outer most namespace of the class ("global" for the global namespace).
+    name_space
+};
+
+// Write the spec into a directory, one file (shard) per library or namespace, rather
+// than into a single stream:
+//
+//   core.<ext>      - collections, helper files, config and extra metadata (no classes)
+//   <shard>.<ext>   - the classes of one shard (and the config)
+//   manifest.<ext>  - class name -> shard, and what other shards each shard depends on
+//
+// The manifest is json for json output, and yaml otherwise. Each shard has its own writer
+// and file, so shards are written as their classes arrive. With compression, every file
+// but the manifest is compressed (and gets the extra extension).
+class sharded_spec_writer : public spec_writer {
+public:
+    sharded_spec_writer(const std::string &directory, spec_format format, spec_shard_by shard_by,
+        spec_compression compression = spec_compression::none, int compression_threads = 0);
+
+    void write_collections(const std::vector<spec_collection> &collections) override;
+
+    void begin_classes() override;
+    void write_class(const spec_class &c) override;
+    void end_classes() override;
+
+    void begin_files() override;
+    void write_file(const spec_file &f) override;
+    void end_files() override;
+
+    void write_config(const spec_config &config) override;
+
+    void finish(const std::string &extra_metadata_path) override;
+
+    // The shard a class will be written to
+    std::string shard_name(const spec_class &c) const;
+
+    // Compression totals over all the files (filled in by `finish`)
+    const compression_stats &compression() const { return m_compression_stats; }
+
+private:
+    // A file, compressed or not
+    struct output_file {
+        std::unique_ptr<std::ofstream> file;
+        std::unique_ptr<compressing_ostream> compressed;
+
+        std::ostream &stream() { if (compressed) { return *compressed; } return *file; }
+        void close();
+    };
+
+    struct shard {
+        output_file out;
+        std::unique_ptr<spec_writer> writer;
+
+        std::vector<std::string> classes;
+
+        // C++ and python type names referenced by the classes in this shard
+        std::set<std::string> referenced_cpp_types;
+        std::set<std::string> referenced_python_types;
+    };
+
+    shard &get_shard(const std::string &name);
+    void open_file(output_file &f, const std::string &path);
+    std::string shard_path(const std::string &name) const;
+    void write_manifest();
+
+    std::string m_directory;
+    spec_format m_format;
+    spec_shard_by m_shard_by;
+    spec_compression m_compression;
+    // Shared by every compressed file, so all the shards together stay within the thread count
+    std::shared_ptr<compression_thread_limit> m_compression_limit;
+
+    output_file m_core_file;
+    compression_stats m_compression_stats;
+    std::unique_ptr<spec_writer> m_core;
+
+    std::map<std::string, shard> m_shards;
+    std::map<std::string, std::string> m_shard_of_cpp_class;
+    std::map<std::string, std::string> m_shard_of_python_class;
+};
+
+#endif
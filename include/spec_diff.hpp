@@ -0,0 +1,73 @@
+#ifndef __spec_diff__
+#define __spec_diff__
+
+#include "yaml-cpp/yaml.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+// Differences between two type specifications (yaml or json, loaded as YAML nodes), and
+// patches that turn the old one into the new one.
+//
+// Collections, classes and files are matched by their canonical name (`collection_name`,
+// `cpp_name` and `name`). Everything else at the top level (config, metadata, etc.) is
+// compared as a whole.
+
+// An entry that is in both specs, but is not the same.
+struct spec_entry_change {
+    YAML::Node before;
+    YAML::Node after;
+};
+
+struct spec_section_diff {
+    // Entries only in the new spec, in new spec order
+    std::vector<YAML::Node> added;
+    // Names of the entries only in the old spec, in old spec order
+    std::vector<std::string> removed;
+    // Entries in both, in new spec order
+    std::vector<spec_entry_change> changed;
+
+    // The names in new spec order, if rebuilding the section from the old one (entries
+    // that are still there keep their place, added ones are merged in by name) would
+    // not give it. Empty otherwise.
+    std::vector<std::string> order;
+
+    bool empty() const { return added.empty() && removed.empty() && changed.empty() && order.empty(); }
+};
+
+struct spec_diff {
+    spec_section_diff collections;
+    spec_section_diff classes;
+    spec_section_diff files;
+
+    // Other top level keys that are new or different (with their new value), or gone.
+    std::map<std::string, YAML::Node> top_level_changed;
+    std::vector<std::string> top_level_removed;
+
+    // The content hash of the old spec (from its config). If it has none, a hash of
+    // everything in it (as loaded) instead, so a patch only applies to the spec it was
+    // made from.
+    std::string base_content_hash;
+    std::string base_fingerprint;
+
+    bool empty() const;
+};
+
+// Find everything that changed between two specs.
+spec_diff diff_specs(const YAML::Node &old_spec, const YAML::Node &new_spec);
+
+// The diff as a patch document, which can be written out as yaml or json.
+YAML::Node spec_patch(const spec_diff &diff);
+
+// Apply a patch to the spec it was made from, returning the new spec. The result has the
+// same contents as the new spec (though not necessarily the same text). Throws if the patch
+// does not fit the spec, was made from a different spec, or does not say which spec it
+// was made from.
+YAML::Node apply_spec_patch(const YAML::Node &old_spec, const YAML::Node &patch);
+
+// Write a readable summary of the diff, including the methods that changed in each class.
+void write_spec_diff_summary(std::ostream &out, const spec_diff &diff);
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef __spec_writer__
+#define __spec_writer__
+
+#include "class_info.hpp"
+#include "collections_info.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+// The pieces of the type specification as plain data. Everything a writer needs
+// is in these records - writers never have to go back to ROOT or the class map.
+
+struct spec_argument {
+    // Argument name
+    std::string name;
+
+    // The (normalized) type of the argument
+    std::string type;
+};
+
+struct spec_method {
+    std::string name;
+    std::string return_type;
+    std::vector<spec_argument> arguments;
+    std::vector<spec_argument> parameter_arguments;
+
+    // Blank if not used
+    std::string param_helper;
+    std::string param_type_callback;
+};
+
+struct spec_class {
+    std::string python_name;
+    std::string cpp_name;
+
+    // Blank if there is no library to emit
+    std::string library;
+
+    // Only used if this is a container
+    bool is_container;
+    std::string is_container_of_cpp;
+    std::string is_container_of_python;
+
+    // Blank if unknown
+    std::string include_file;
+
+    std::vector<std::string> also_behaves_like;
+
+    // C++ names of the closest emitted base classes. Only filled when each method is
+    // written only on the class that declares it - the rest are found through these.
+    std::vector<std::string> inherits_from;
+
+    std::vector<enum_info> enums;
+    std::vector<spec_method> methods;
+};
+
+struct spec_collection {
+    std::string collection_name;
+    std::string cpp_item_type;
+    std::string python_item_type;
+    std::string cpp_container_type;
+    std::string python_container_type;
+    std::string include_file;
+    std::vector<std::string> link_libraries;
+
+    // If this collection has entries in the collection config, they are here. Otherwise
+    // the collection just gets the default `name` parameter.
+    bool has_metadata;
+    collection_extra metadata;
+};
+
+struct spec_file {
+    // Name the file should be written as
+    std::string name;
+
+    // Lines to add to the package __init__
+    std::vector<std::string> init_lines;
+
+    // The contents of the file, one entry per line (right trimmed).
+    std::vector<std::string> contents;
+
+    // Write the contents as one block of text (with its hash) rather than line by line.
+    bool as_text = false;
+    std::string content_hash;
+
+    // If not blank, the contents are the same as this file in the reference spec
+    // named here, and are not written out.
+    std::string reference;
+};
+
+struct spec_config {
+    std::string atlas_release;
+    std::vector<std::string> dataset_types;
+
+    // True if inherited methods are not repeated on derived classes
+    bool declared_methods_only = false;
+
+    // Hash of the spec contents, and of everything that went into making it. Blank
+    // if not known.
+    std::string content_hash;
+    std::string inputs_hash;
+};
+
+// Something that can write out a type specification. The calls are always made in
+// this order, with each class and file written as soon as it is ready:
+//
+//   write_collections
+//   begin_classes, write_class..., end_classes
+//   begin_files, write_file..., end_files
+//   write_config
+//   finish
+class spec_writer {
+public:
+    virtual ~spec_writer() {}
+
+    virtual void write_collections(const std::vector<spec_collection> &collections) = 0;
+
+    virtual void begin_classes() = 0;
+    virtual void write_class(const spec_class &c) = 0;
+    virtual void end_classes() = 0;
+
+    virtual void begin_files() = 0;
+    virtual void write_file(const spec_file &f) = 0;
+    virtual void end_files() = 0;
+
+    virtual void write_config(const spec_config &config) = 0;
+
+    // Close off the spec, and add the contents of the extra metadata file.
+    virtual void finish(const std::string &extra_metadata_path) = 0;
+};
+
+// The output format of the type specification
+enum class spec_format {
+    yaml,
+    json,
+    // Classes only, see binary_spec_format.hpp
+    binary
+};
+
+// Create a writer for the format, writing to `out`.
+std::unique_ptr<spec_writer> make_spec_writer(spec_format format, std::ostream &out);
+
+// File extension (without the dot) used for a format
+std::string spec_file_extension(spec_format format);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __synthetic_edm__
+#define __synthetic_edm__
+
+#include <string>
+#include <vector>
+
+// Write the headers and LinkDef file for a made up event data model of any size, shaped
+// like the xAOD: versioned classes in a namespace, inheriting from chains of base classes,
+// with enums, `DataVector` containers, `ElementLink`s and nested templates. Run rootcling
+// on the result to get a dictionary generate_types can be pointed at (see the scale tests
+// in CMakeLists.txt).
+//
+// Every class can be reached from `<name_space>::Event_v1`: class i refers to the containers
+// of classes 2i+1 and 2i+2.
+struct synthetic_edm_config {
+    // Number of classes (not counting base classes, containers, etc.)
+    int n_classes = 1000;
+
+    // Each class inherits from a chain of this many base classes.
+    int inheritance_depth = 2;
+
+    // How deep the nested template return types go (vector<vector<...>>)
+    int template_depth = 2;
+
+    // Enums per class
+    int enums_per_class = 1;
+
+    // How many classes go in each header
+    int classes_per_header = 500;
+
+    std::string name_space = "synthetic";
+};
+
+// Header files (relative to `directory`) that hold the classes, in order.
+std::vector<std::string> synthetic_edm_headers(const synthetic_edm_config &config);
+
+// Write the headers and `LinkDef.h` into `directory` (created if needed). The headers
+// include each other as "SyntheticEDM/...", so `directory` needs to be on the include path.
+void write_synthetic_edm(const synthetic_edm_config &config, const std::string &directory);
+
+// C++ name of class `index`
+std::string synthetic_edm_class_name(const synthetic_edm_config &config, int index);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef __trace__
+#define __trace__
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <map>
+
+// One span of time in the trace
+struct trace_event {
+    std::string name;
+    std::string category;
+
+    // Shown with the span (e.g. the class name). May be blank.
+    std::string detail;
+
+    // Micro-seconds from the start of the trace
+    double start_us = 0.0;
+    double duration_us = 0.0;
+
+    // Small integer for the thread the span ran on
+    int thread = 0;
+};
+
+// Collects spans from any thread, and writes them out in the Chrome trace-event
+// format (load in chrome://tracing or https://ui.perfetto.dev). Spans on the
+// same thread nest by time.
+class trace_recorder {
+public:
+    trace_recorder();
+
+    // Add a finished span
+    void add(const std::string &name, const std::string &category, const std::string &detail,
+        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    std::vector<trace_event> events() const;
+
+    // Write the trace as `{"traceEvents": [...]}`
+    void write(std::ostream &out) const;
+
+private:
+    int thread_index(std::thread::id id);
+
+    std::chrono::steady_clock::time_point m_start;
+    mutable std::mutex m_lock;
+    std::vector<trace_event> m_events;
+    std::map<std::thread::id, int> m_threads;
+};
+
+// The recorder spans go to, or null if tracing is off (the default).
+trace_recorder *active_trace();
+
+// Send spans to this recorder (or nullptr to stop), returning the old one.
+trace_recorder *set_active_trace(trace_recorder *trace);
+
+// A span from construction to destruction. Does nothing if tracing is off, so
+// the detail is only copied when it will be used.
+class scoped_trace_span {
+public:
+    scoped_trace_span(const char *name, const char *category)
+        : m_trace(active_trace()), m_name(name), m_category(category)
+    {
+        if (m_trace != nullptr) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+    scoped_trace_span(const char *name, const char *category, const std::string &detail)
+        : scoped_trace_span(name, category)
+    {
+        if (m_trace != nullptr) {
+            m_detail = detail;
+        }
+    }
+    ~scoped_trace_span() {
+        if (m_trace != nullptr) {
+            m_trace->add(m_name, m_category, m_detail, m_start, std::chrono::steady_clock::now());
+        }
+    }
+
+    scoped_trace_span(const scoped_trace_span &) = delete;
+    scoped_trace_span &operator=(const scoped_trace_span &) = delete;
+
+private:
+    trace_recorder *m_trace;
+    const char *m_name;
+    const char *m_category;
+    std::string m_detail;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
@@ -7,4 +7,7 @@
 
 class_info translate_class(const std::string &class_name);
 
+// The library name from its shared library ("libxAODJetDict.so" -> "xAODJet")
+std::string clean_so_name(std::string original_name);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef __translate_profile__
+#define __translate_profile__
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include <mutex>
+
+// Where the time went when translating one class
+struct class_translate_timing {
+    std::string name;
+
+    // Loading template arguments, and fetching the class from the type system
+    // (which includes its methods and enums).
+    double lookup_seconds = 0.0;
+
+    // Filtering and translating the methods, including walking the base classes
+    double methods_seconds = 0.0;
+    double enums_seconds = 0.0;
+
+    // Finding and checking the include file
+    double include_seconds = 0.0;
+
+    double total_seconds() const {
+        return lookup_seconds + methods_seconds + enums_seconds + include_seconds;
+    }
+};
+
+// Timing of every class translated while this is active.
+class translate_profile {
+public:
+    void add(const class_translate_timing &timing);
+
+    std::vector<class_translate_timing> classes() const;
+
+    // The `n` slowest classes, slowest first
+    std::vector<class_translate_timing> slowest(size_t n) const;
+
+private:
+    mutable std::mutex m_lock;
+    std::vector<class_translate_timing> m_classes;
+};
+
+// The profile translate_class reports to, or null if profiling is off (the default).
+translate_profile *active_translate_profile();
+
+// Report to this profile (or nullptr to stop), returning the old one.
+translate_profile *set_active_translate_profile(translate_profile *profile);
+
+// Times the steps of one class translation, and reports them to the active profile when
+// it goes out of scope. Time after the last lap counts as lookup (e.g. a class that was
+// not found). Does nothing if there is no active profile.
+class class_translate_stopwatch {
+public:
+    class_translate_stopwatch(const std::string &class_name);
+    ~class_translate_stopwatch();
+
+    // Add the time since the last lap (or the start) to this step
+    void lap(double class_translate_timing::*step);
+
+private:
+    translate_profile *m_profile;
+    class_translate_timing m_timing;
+    std::chrono::steady_clock::time_point m_last;
+};
+
+// Histogram of the total translation time of each class, one line per bucket.
+void write_translate_histogram(std::ostream &out, const translate_profile &profile);
+
+// The `n` slowest classes, with the time of each step.
+void write_slowest_classes(std::ostream &out, const translate_profile &profile, size_t n);
+
+#endif
@@ -25,6 +25,10 @@ void fixup_type_defs(std::vector<class_info> &classes);
 // Return the typedefs we know about
 std::map<std::string, std::vector<std::string>> root_typedef_map();
 
+// The typedefs are read from ROOT once and cached. Drop the cache so it is rebuilt
+// (e.g. after more libraries have been loaded).
+void clear_typedef_cache();
+
 // Return the actual name of a class, peering through all typedefs
 std::string resolve_typedef(const std::string &c_name);
 
@@ -63,6 +67,14 @@ typename_info container_of(const typename_info &ti);
 bool is_collection(const class_info &ci);
 typename_info container_of(const class_info &ci);
 
+// Same as container_of, but failure is reported by returning false rather than
+// throwing. If `why` is given, it is filled with the reason for the failure.
+bool try_container_of(const class_info &ci, typename_info &contained_type, std::string *why = nullptr);
+
+// Classify every class as a container or not, once, and record the result
+// in the class (`is_container` and `container_type`).
+void classify_containers(std::vector<class_info> &classes);
+
 // Return list of referenced types
 std::set<std::string> type_referenced_types(const typename_info &t);
 
@@ -70,14 +82,51 @@ std::set<std::string> type_referenced_types(const typename_info &t);
 bool is_understood_type(const std::string &t_name, const std::set<std::string> &known_types);
 bool is_understood_type(const typename_info &t, const std::set<std::string> &known_types);
 
+// Cache of "is this type understood?" verdicts. Verdicts are only good for a
+// particular version of the known types - point the cache at a new set with
+// `reset`, which bumps the version and drops everything cached so far.
+class understood_type_cache
+{
+public:
+    understood_type_cache(const std::set<std::string> &known_types);
+
+    // Use a new (or rebuilt) set of known types.
+    void reset(const std::set<std::string> &known_types);
+
+    // Is this type in the known types? The unqualified name is returned
+    // so callers can check it against any extra types they allow.
+    bool is_understood(const std::string &t_name);
+    const std::string &unqualified_name(const std::string &t_name);
+
+    unsigned int version() const { return m_version; }
+    const std::set<std::string> &known_types() const { return *m_known_types; }
+
+private:
+    struct verdict {
+        std::string unqualified_name;
+        bool understood;
+    };
+    const verdict &lookup(const std::string &t_name);
+
+    const std::set<std::string> *m_known_types;
+    unsigned int m_version;
+    std::map<std::string, verdict> m_verdicts;
+};
+
 // Is this method something we can deal with?
 bool is_understood_method(const method_info &meth, const std::set<std::string> &classes_to_emit);
+bool is_understood_method(const method_info &meth, understood_type_cache &known_types);
+
+// Is this one of the fundamental (non-class) types, like int or unsigned char?
+bool is_fundamental_type(const std::string &t_name);
+
+// Is this type in one of the listed (outer most) namespaces? "::" stands for
+// the global namespace. Templates in the global namespace (vector, DataVector, etc.)
+// take on the namespace of their arguments.
+bool type_in_namespaces(const typename_info &t, const std::set<std::string> &namespaces);
 
 // Return the python version of the typename.
 typename_info py_typename(const std::string &t_name);
 typename_info py_typename(const typename_info &t);
 
-// Return a TClass, but skip internal classes.
-class TClass;
-TClass *get_tclass(const std::string &name);
 #endif
@@ -0,0 +1,39 @@
+#ifndef __yaml_spec_writer__
+#define __yaml_spec_writer__
+
+#include "spec_writer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <ostream>
+
+// Write the spec as yaml. Everything goes straight to the output stream as it
+// is written, so only the record currently being written is held in memory.
+class yaml_spec_writer : public spec_writer {
+public:
+    yaml_spec_writer(std::ostream &out);
+
+    void write_collections(const std::vector<spec_collection> &collections) override;
+
+    void begin_classes() override;
+    void write_class(const spec_class &c) override;
+    void end_classes() override;
+
+    void begin_files() override;
+    void write_file(const spec_file &f) override;
+    void end_files() override;
+
+    void write_config(const spec_config &config) override;
+
+    void finish(const std::string &extra_metadata_path) override;
+
+private:
+    std::ostream &m_stream;
+    YAML::Emitter m_out;
+    bool m_files_header_written;
+};
+
+// Copy the contents of a file to the output stream.
+void append_file(std::ostream &out, const std::string &path);
+
+#endif
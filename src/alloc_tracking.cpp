@@ -0,0 +1,161 @@
+#include "alloc_tracking.hpp"
+
+#ifdef TRACK_ALLOCATIONS
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+alloc_totals alloc_totals::operator-(const alloc_totals &earlier) const
+{
+    alloc_totals result;
+    result.allocations = allocations - earlier.allocations;
+    result.frees = frees - earlier.frees;
+    result.bytes_allocated = bytes_allocated - earlier.bytes_allocated;
+    return result;
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+namespace {
+    // Plain atomics, so they are ready before any static constructor allocates
+    atomic<uint64_t> _g_allocations(0);
+    atomic<uint64_t> _g_frees(0);
+    atomic<uint64_t> _g_bytes_allocated(0);
+    atomic<uint64_t> _g_live_bytes(0);
+
+    // The peak since the last reset, and the most any earlier window reached
+    atomic<uint64_t> _g_peak_live_bytes(0);
+    atomic<uint64_t> _g_earlier_peak_live_bytes(0);
+
+    void raise_to(atomic<uint64_t> &peak, uint64_t value) {
+        auto current = peak.load(memory_order_relaxed);
+        while (value > current && !peak.compare_exchange_weak(current, value, memory_order_relaxed)) {
+        }
+    }
+
+    void *tracked_alloc(size_t size) noexcept {
+        _g_allocations.fetch_add(1, memory_order_relaxed);
+        _g_bytes_allocated.fetch_add(size, memory_order_relaxed);
+        auto p = malloc(size == 0 ? 1 : size);
+        if (p != nullptr) {
+            uint64_t usable = malloc_usable_size(p);
+            auto live = _g_live_bytes.fetch_add(usable, memory_order_relaxed) + usable;
+            raise_to(_g_peak_live_bytes, live);
+        }
+        return p;
+    }
+
+    void tracked_free(void *p) noexcept {
+        if (p != nullptr) {
+            _g_frees.fetch_add(1, memory_order_relaxed);
+            _g_live_bytes.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+            free(p);
+        }
+    }
+
+    void *tracked_alloc_or_throw(size_t size) {
+        auto p = tracked_alloc(size);
+        if (p == nullptr) {
+            throw bad_alloc();
+        }
+        return p;
+    }
+}
+
+bool allocations_tracked()
+{
+    return true;
+}
+
+alloc_totals read_alloc_totals()
+{
+    alloc_totals result;
+    result.allocations = _g_allocations.load(memory_order_relaxed);
+    result.frees = _g_frees.load(memory_order_relaxed);
+    result.bytes_allocated = _g_bytes_allocated.load(memory_order_relaxed);
+    return result;
+}
+
+uint64_t tracked_live_bytes()
+{
+    return _g_live_bytes.load(memory_order_relaxed);
+}
+
+uint64_t tracked_peak_live_bytes()
+{
+    return max(_g_peak_live_bytes.load(memory_order_relaxed), _g_earlier_peak_live_bytes.load(memory_order_relaxed));
+}
+
+uint64_t recent_peak_live_bytes()
+{
+    return _g_peak_live_bytes.load(memory_order_relaxed);
+}
+
+uint64_t reset_recent_peak_live_bytes()
+{
+    auto old_peak = _g_peak_live_bytes.exchange(_g_live_bytes.load(memory_order_relaxed), memory_order_relaxed);
+    raise_to(_g_earlier_peak_live_bytes, old_peak);
+    return old_peak;
+}
+
+void raise_recent_peak_live_bytes(uint64_t bytes)
+{
+    raise_to(_g_peak_live_bytes, bytes);
+}
+
+// The replacements. The over-aligned versions are left alone (and not counted) - nothing
+// here asks for over-aligned memory.
+void *operator new(size_t size) { return tracked_alloc_or_throw(size); }
+void *operator new[](size_t size) { return tracked_alloc_or_throw(size); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return tracked_alloc(size); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return tracked_alloc(size); }
+
+void operator delete(void *p) noexcept { tracked_free(p); }
+void operator delete[](void *p) noexcept { tracked_free(p); }
+void operator delete(void *p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void *p, size_t) noexcept { tracked_free(p); }
+void operator delete(void *p, const nothrow_t &) noexcept { tracked_free(p); }
+void operator delete[](void *p, const nothrow_t &) noexcept { tracked_free(p); }
+
+#else
+
+bool allocations_tracked()
+{
+    return false;
+}
+
+alloc_totals read_alloc_totals()
+{
+    return alloc_totals();
+}
+
+uint64_t tracked_live_bytes()
+{
+    return 0;
+}
+
+uint64_t tracked_peak_live_bytes()
+{
+    return 0;
+}
+
+uint64_t recent_peak_live_bytes()
+{
+    return 0;
+}
+
+uint64_t reset_recent_peak_live_bytes()
+{
+    return 0;
+}
+
+void raise_recent_peak_live_bytes(uint64_t)
+{
+}
+
+#endif
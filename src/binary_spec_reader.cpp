@@ -0,0 +1,211 @@
+#include "binary_spec_reader.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+binary_spec_reader::binary_spec_reader(const string &path)
+    : m_data(nullptr), m_size(0), m_header(nullptr)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Unable to open binary spec file " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(spec_bin_header)) {
+        close(fd);
+        throw runtime_error("File " + path + " is too small to be a binary spec");
+    }
+    m_size = info.st_size;
+    auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw runtime_error("Unable to memory map binary spec file " + path);
+    }
+    m_data = static_cast<const char*>(data);
+    m_header = reinterpret_cast<const spec_bin_header*>(m_data);
+
+    // Make sure this is a file we understand, and none of the tables run off the end.
+    string bad;
+    if (memcmp(m_header->magic, spec_bin_magic, sizeof(spec_bin_magic)) != 0) {
+        bad = "it is not a binary spec file";
+    } else if (m_header->version != spec_bin_version) {
+        bad = "it is version " + to_string(m_header->version) + " (expected " + to_string(spec_bin_version) + ")";
+    } else {
+        auto fits = [this](const spec_bin_range &r, size_t item_size) {
+            return r.first <= m_size && r.count <= (m_size - r.first) / item_size;
+        };
+        if (!fits(m_header->classes, sizeof(spec_bin_class))
+            || !fits(m_header->class_index, sizeof(uint32_t))
+            || !fits(m_header->methods, sizeof(spec_bin_method))
+            || !fits(m_header->arguments, sizeof(spec_bin_argument))
+            || !fits(m_header->enums, sizeof(spec_bin_enum))
+            || !fits(m_header->enum_values, sizeof(spec_bin_enum_value))
+            || !fits(m_header->string_lists, sizeof(uint32_t))
+            || !fits(m_header->strings, 1)
+            || m_header->strings.count == 0
+            || m_data[m_header->strings.first + m_header->strings.count - 1] != '\0') {
+            bad = "it is truncated or corrupt";
+        }
+    }
+    if (bad.size() > 0) {
+        munmap(const_cast<char*>(m_data), m_size);
+        throw runtime_error("Unable to read binary spec file " + path + ": " + bad);
+    }
+}
+
+binary_spec_reader::~binary_spec_reader()
+{
+    munmap(const_cast<char*>(m_data), m_size);
+}
+
+template <class T>
+binary_spec_reader::records<T> binary_spec_reader::table(const spec_bin_range &table_range) const
+{
+    return records<T>{reinterpret_cast<const T*>(m_data + table_range.first), table_range.count};
+}
+
+// Part of a table. Anything pointing outside the table comes back empty.
+template <class T>
+binary_spec_reader::records<T> binary_spec_reader::sub_range(const records<T> &all, const spec_bin_range &r) const
+{
+    if (r.first > all.count || r.count > all.count - r.first) {
+        return records<T>{all.first, 0};
+    }
+    return records<T>{all.first + r.first, r.count};
+}
+
+string_view binary_spec_reader::string_at(uint32_t id) const
+{
+    if (id >= m_header->strings.count) {
+        return string_view();
+    }
+    return string_view(m_data + m_header->strings.first + id);
+}
+
+string_view binary_spec_reader::atlas_release() const
+{
+    return string_at(m_header->atlas_release);
+}
+
+string_view binary_spec_reader::content_hash() const
+{
+    return string_at(m_header->content_hash);
+}
+
+string_view binary_spec_reader::inputs_hash() const
+{
+    return string_at(m_header->inputs_hash);
+}
+
+bool binary_spec_reader::declared_methods_only() const
+{
+    return m_header->declared_methods_only != 0;
+}
+
+binary_spec_reader::records<spec_bin_class> binary_spec_reader::classes() const
+{
+    return table<spec_bin_class>(m_header->classes);
+}
+
+const spec_bin_class *binary_spec_reader::find_class(string_view cpp_name) const
+{
+    auto all_classes = classes();
+    auto index = table<uint32_t>(m_header->class_index);
+    auto itr = lower_bound(index.begin(), index.end(), cpp_name, [this, &all_classes](uint32_t c_index, string_view name) {
+        return c_index < all_classes.count && string_at(all_classes[c_index].cpp_name) < name;
+    });
+    if (itr == index.end() || *itr >= all_classes.count || string_at(all_classes[*itr].cpp_name) != cpp_name) {
+        return nullptr;
+    }
+    return &all_classes[*itr];
+}
+
+binary_spec_reader::records<spec_bin_method> binary_spec_reader::methods(const spec_bin_class &c) const
+{
+    return sub_range(table<spec_bin_method>(m_header->methods), c.methods);
+}
+
+binary_spec_reader::records<spec_bin_enum> binary_spec_reader::enums(const spec_bin_class &c) const
+{
+    return sub_range(table<spec_bin_enum>(m_header->enums), c.enums);
+}
+
+binary_spec_reader::records<spec_bin_enum_value> binary_spec_reader::values(const spec_bin_enum &e) const
+{
+    return sub_range(table<spec_bin_enum_value>(m_header->enum_values), e.values);
+}
+
+binary_spec_reader::records<uint32_t> binary_spec_reader::also_behaves_like(const spec_bin_class &c) const
+{
+    return sub_range(table<uint32_t>(m_header->string_lists), c.also_behaves_like);
+}
+
+binary_spec_reader::records<uint32_t> binary_spec_reader::inherits_from(const spec_bin_class &c) const
+{
+    return sub_range(table<uint32_t>(m_header->string_lists), c.inherits_from);
+}
+
+binary_spec_reader::records<spec_bin_argument> binary_spec_reader::arguments(const spec_bin_method &m) const
+{
+    return sub_range(table<spec_bin_argument>(m_header->arguments), m.arguments);
+}
+
+binary_spec_reader::records<spec_bin_argument> binary_spec_reader::parameter_arguments(const spec_bin_method &m) const
+{
+    return sub_range(table<spec_bin_argument>(m_header->arguments), m.parameter_arguments);
+}
+
+spec_class binary_spec_reader::read_class(const spec_bin_class &c) const
+{
+    auto str = [this](uint32_t id) { return string(string_at(id)); };
+
+    spec_class result;
+    result.python_name = str(c.python_name);
+    result.cpp_name = str(c.cpp_name);
+    result.library = str(c.library);
+    result.include_file = str(c.include_file);
+    result.is_container = c.is_container != 0;
+    result.is_container_of_cpp = str(c.is_container_of_cpp);
+    result.is_container_of_python = str(c.is_container_of_python);
+
+    for (auto &&b : also_behaves_like(c)) {
+        result.also_behaves_like.push_back(str(b));
+    }
+    for (auto &&b : inherits_from(c)) {
+        result.inherits_from.push_back(str(b));
+    }
+
+    for (auto &&e : enums(c)) {
+        enum_info e_info;
+        e_info.name = str(e.name);
+        for (auto &&v : values(e)) {
+            e_info.values.push_back(make_pair(str(v.name), static_cast<int>(v.value)));
+        }
+        result.enums.push_back(e_info);
+    }
+
+    for (auto &&m : methods(c)) {
+        spec_method s_m;
+        s_m.name = str(m.name);
+        s_m.return_type = str(m.return_type);
+        for (auto &&arg : arguments(m)) {
+            s_m.arguments.push_back(spec_argument{str(arg.name), str(arg.type)});
+        }
+        for (auto &&arg : parameter_arguments(m)) {
+            s_m.parameter_arguments.push_back(spec_argument{str(arg.name), str(arg.type)});
+        }
+        s_m.param_helper = str(m.param_helper);
+        s_m.param_type_callback = str(m.param_type_callback);
+        result.methods.push_back(s_m);
+    }
+
+    return result;
+}
@@ -0,0 +1,157 @@
+#include "binary_spec_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+
+using namespace std;
+
+namespace {
+    // Record where a table will go in the file, and move the offset past it.
+    template <class T>
+    void place_table(const vector<T> &table, spec_bin_range &where, size_t &offset) {
+        where.first = static_cast<uint32_t>(offset);
+        where.count = static_cast<uint32_t>(table.size());
+        offset += table.size() * sizeof(T);
+    }
+
+    template <class T>
+    void write_table(ostream &out, const vector<T> &table) {
+        out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(T));
+    }
+}
+
+binary_spec_writer::binary_spec_writer(ostream &out)
+    : m_out(out), m_atlas_release(0), m_declared_methods_only(false), m_content_hash(0), m_inputs_hash(0)
+{
+    // Make sure the empty string is id 0
+    m_strings.push_back('\0');
+    m_string_ids[""] = 0;
+}
+
+uint32_t binary_spec_writer::string_id(const string &s)
+{
+    auto itr = m_string_ids.find(s);
+    if (itr != m_string_ids.end()) {
+        return itr->second;
+    }
+    auto id = static_cast<uint32_t>(m_strings.size());
+    m_strings.append(s);
+    m_strings.push_back('\0');
+    m_string_ids[s] = id;
+    return id;
+}
+
+spec_bin_range binary_spec_writer::add_arguments(const vector<spec_argument> &arguments)
+{
+    spec_bin_range r{static_cast<uint32_t>(m_arguments.size()), static_cast<uint32_t>(arguments.size())};
+    for (auto &&arg : arguments) {
+        m_arguments.push_back(spec_bin_argument{string_id(arg.name), string_id(arg.type)});
+    }
+    return r;
+}
+
+spec_bin_range binary_spec_writer::add_string_list(const vector<string> &strings)
+{
+    spec_bin_range r{static_cast<uint32_t>(m_string_lists.size()), static_cast<uint32_t>(strings.size())};
+    for (auto &&s : strings) {
+        m_string_lists.push_back(string_id(s));
+    }
+    return r;
+}
+
+void binary_spec_writer::write_class(const spec_class &c)
+{
+    spec_bin_class b_c;
+    b_c.python_name = string_id(c.python_name);
+    b_c.cpp_name = string_id(c.cpp_name);
+    b_c.library = string_id(c.library);
+    b_c.include_file = string_id(c.include_file);
+    b_c.is_container = c.is_container ? 1 : 0;
+    b_c.is_container_of_cpp = string_id(c.is_container_of_cpp);
+    b_c.is_container_of_python = string_id(c.is_container_of_python);
+
+    b_c.also_behaves_like = add_string_list(c.also_behaves_like);
+    b_c.inherits_from = add_string_list(c.inherits_from);
+
+    b_c.enums = spec_bin_range{static_cast<uint32_t>(m_enums.size()), static_cast<uint32_t>(c.enums.size())};
+    for (auto &&e : c.enums) {
+        m_enums.push_back(spec_bin_enum{string_id(e.name),
+            spec_bin_range{static_cast<uint32_t>(m_enum_values.size()), static_cast<uint32_t>(e.values.size())}});
+        for (auto &&v : e.values) {
+            m_enum_values.push_back(spec_bin_enum_value{string_id(v.first), v.second});
+        }
+    }
+
+    b_c.methods = spec_bin_range{static_cast<uint32_t>(m_methods.size()), static_cast<uint32_t>(c.methods.size())};
+    for (auto &&meth : c.methods) {
+        spec_bin_method b_m;
+        b_m.name = string_id(meth.name);
+        b_m.return_type = string_id(meth.return_type);
+        b_m.arguments = add_arguments(meth.arguments);
+        b_m.parameter_arguments = add_arguments(meth.parameter_arguments);
+        b_m.param_helper = string_id(meth.param_helper);
+        b_m.param_type_callback = string_id(meth.param_type_callback);
+        m_methods.push_back(b_m);
+    }
+
+    m_classes.push_back(b_c);
+}
+
+void binary_spec_writer::write_config(const spec_config &config)
+{
+    m_atlas_release = string_id(config.atlas_release);
+    m_declared_methods_only = config.declared_methods_only;
+    m_content_hash = string_id(config.content_hash);
+    m_inputs_hash = string_id(config.inputs_hash);
+}
+
+void binary_spec_writer::finish(const string &)
+{
+    // The index of classes, sorted by C++ name.
+    vector<uint32_t> class_index(m_classes.size());
+    for (uint32_t i = 0; i < class_index.size(); i++) {
+        class_index[i] = i;
+    }
+    auto name_of = [this](uint32_t c_index) {
+        return m_strings.c_str() + m_classes[c_index].cpp_name;
+    };
+    sort(class_index.begin(), class_index.end(), [&name_of](uint32_t a, uint32_t b) {
+        return strcmp(name_of(a), name_of(b)) < 0;
+    });
+
+    spec_bin_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, spec_bin_magic, sizeof(header.magic));
+    header.version = spec_bin_version;
+    header.atlas_release = m_atlas_release;
+    header.declared_methods_only = m_declared_methods_only ? 1 : 0;
+    header.content_hash = m_content_hash;
+    header.inputs_hash = m_inputs_hash;
+
+    // All the tables go, in order, right after the header.
+    size_t offset = sizeof(header);
+    place_table(m_classes, header.classes, offset);
+    place_table(class_index, header.class_index, offset);
+    place_table(m_methods, header.methods, offset);
+    place_table(m_arguments, header.arguments, offset);
+    place_table(m_enums, header.enums, offset);
+    place_table(m_enum_values, header.enum_values, offset);
+    place_table(m_string_lists, header.string_lists, offset);
+    if (offset + m_strings.size() > numeric_limits<uint32_t>::max()) {
+        throw runtime_error("Binary spec is too large (more than 4GB)");
+    }
+    header.strings = spec_bin_range{static_cast<uint32_t>(offset), static_cast<uint32_t>(m_strings.size())};
+
+    m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_table(m_out, m_classes);
+    write_table(m_out, class_index);
+    write_table(m_out, m_methods);
+    write_table(m_out, m_arguments);
+    write_table(m_out, m_enums);
+    write_table(m_out, m_enum_values);
+    write_table(m_out, m_string_lists);
+    m_out.write(m_strings.data(), m_strings.size());
+    m_out.flush();
+}
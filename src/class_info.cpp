@@ -232,4 +232,53 @@ vector<method_info> get_method(const class_info &ci, const string &name)
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+// Return the first method with a given name.
+// nullptr is returned if the method isn't found.
+const method_info *find_method(const class_info &ci, const string &name)
+{
+    for (auto &&m: ci.methods)
+    {
+        if (m.name == name) {
+            return &m;
+        }
+    }
+
+    return nullptr;
+}
+
+namespace {
+    void walk_ancestors(const class_info &ci, const map<string, const class_info*> &classes,
+        const set<string> &emitted, bool nearest, vector<string> &nearest_found,
+        set<string> &all_emitted, set<string> &visited)
+    {
+        for (auto &&b : ci.inherited_class_names)
+        {
+            if (!visited.insert(b).second) {
+                continue;
+            }
+            bool is_emitted = emitted.find(b) != emitted.end();
+            if (is_emitted) {
+                all_emitted.insert(b);
+                if (nearest) {
+                    nearest_found.push_back(b);
+                }
+            }
+            auto b_info = classes.find(b);
+            if (b_info != classes.end()) {
+                walk_ancestors(*b_info->second, classes, emitted, nearest && !is_emitted, nearest_found, all_emitted, visited);
+            }
+        }
+    }
+}
+
+vector<string> nearest_emitted_ancestors(const class_info &ci,
+    const map<string, const class_info*> &classes, const set<string> &emitted,
+    set<string> &all_emitted)
+{
+    vector<string> result;
+    set<string> visited;
+    walk_ancestors(ci, classes, emitted, true, result, all_emitted, visited);
+    return result;
+}
@@ -0,0 +1,245 @@
+#include "compressing_streambuf.hpp"
+
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    // Compress a block as one complete gzip member
+    string gzip_compress(const string &input) {
+        z_stream zs;
+        zs.zalloc = Z_NULL;
+        zs.zfree = Z_NULL;
+        zs.opaque = Z_NULL;
+        // 15 + 16 gets the gzip header and trailer
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw runtime_error("Unable to initialize zlib compression");
+        }
+
+        string output(deflateBound(&zs, input.size()) + 32, '\0');
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        zs.avail_in = static_cast<uInt>(input.size());
+        zs.next_out = reinterpret_cast<Bytef*>(&output[0]);
+        zs.avail_out = static_cast<uInt>(output.size());
+        auto status = deflate(&zs, Z_FINISH);
+        deflateEnd(&zs);
+        if (status != Z_STREAM_END) {
+            throw runtime_error("zlib compression failed");
+        }
+        output.resize(zs.total_out);
+        return output;
+    }
+
+#ifdef HAVE_ZSTD
+    // Compress a block as one complete zstd frame
+    string zstd_compress(const string &input) {
+        string output(ZSTD_compressBound(input.size()), '\0');
+        auto size = ZSTD_compress(&output[0], output.size(), input.data(), input.size(), 3);
+        if (ZSTD_isError(size)) {
+            throw runtime_error(string("zstd compression failed: ") + ZSTD_getErrorName(size));
+        }
+        output.resize(size);
+        return output;
+    }
+#endif
+}
+
+bool compression_available(spec_compression method)
+{
+    switch (method) {
+        case spec_compression::none:
+        case spec_compression::gzip:
+            return true;
+        case spec_compression::zstd:
+#ifdef HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+string compression_file_extension(spec_compression method)
+{
+    switch (method) {
+        case spec_compression::gzip:
+            return ".gz";
+        case spec_compression::zstd:
+            return ".zst";
+        default:
+            return "";
+    }
+}
+
+compression_thread_limit::compression_thread_limit(int threads)
+{
+    if (threads <= 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    m_threads = threads;
+    m_free = threads;
+}
+
+void compression_thread_limit::acquire()
+{
+    unique_lock<mutex> guard(m_lock);
+    m_freed.wait(guard, [this]() { return m_free > 0; });
+    m_free--;
+}
+
+void compression_thread_limit::release()
+{
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_free++;
+    }
+    m_freed.notify_one();
+}
+
+compressing_streambuf::compressing_streambuf(ostream &out, spec_compression method, int threads, size_t chunk_size)
+    : compressing_streambuf(out, method, make_shared<compression_thread_limit>(threads), chunk_size)
+{
+}
+
+compressing_streambuf::compressing_streambuf(ostream &out, spec_compression method,
+    shared_ptr<compression_thread_limit> limit, size_t chunk_size)
+    : m_out(out), m_method(method), m_limit(limit), m_max_in_flight(limit->threads()),
+      m_chunk_size(max(chunk_size, size_t(1))), m_put_area(64 * 1024), m_finished(false),
+      m_bytes_in(0), m_bytes_out(0), m_compress_seconds(0), m_wait_seconds(0)
+{
+    if (!compression_available(method)) {
+        throw runtime_error("This build does not support the requested compression (zstd was not found at build time)");
+    }
+    setp(m_put_area.data(), m_put_area.data() + m_put_area.size());
+}
+
+compressing_streambuf::~compressing_streambuf()
+{
+    try {
+        finish();
+    } catch (...) {
+        // Nothing can be done about it in a destructor - `finish` should have been called.
+    }
+}
+
+compressing_streambuf::int_type compressing_streambuf::overflow(int_type ch)
+{
+    drain_put_area();
+    if (ch != traits_type::eof()) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int compressing_streambuf::sync()
+{
+    drain_put_area();
+    return 0;
+}
+
+void compressing_streambuf::drain_put_area()
+{
+    append(pbase(), pptr() - pbase());
+    setp(m_put_area.data(), m_put_area.data() + m_put_area.size());
+}
+
+void compressing_streambuf::append(const char *s, size_t n)
+{
+    auto left = n;
+    while (left > 0) {
+        auto take = min(left, m_chunk_size - m_buffer.size());
+        m_buffer.append(s, take);
+        s += take;
+        left -= take;
+        if (m_buffer.size() >= m_chunk_size) {
+            submit_chunk();
+        }
+    }
+    m_bytes_in += n;
+}
+
+void compressing_streambuf::submit_chunk(bool even_if_empty)
+{
+    if (m_buffer.size() == 0 && !even_if_empty) {
+        return;
+    }
+
+    // Keep the number of chunks being compressed at once bounded.
+    while (m_in_flight.size() >= m_max_in_flight) {
+        write_oldest();
+    }
+
+    // Take a thread from the (perhaps shared) limit before starting one. It is given
+    // back as soon as the chunk is compressed, whoever writes it out.
+    m_limit->acquire();
+    auto method = m_method;
+    auto limit = m_limit;
+    m_in_flight.push_back(async(launch::async, [method, limit](string input) {
+        struct release_on_exit {
+            compression_thread_limit &limit;
+            ~release_on_exit() { limit.release(); }
+        } release{*limit};
+
+        auto start = chrono::steady_clock::now();
+        compressed_chunk result;
+        if (method == spec_compression::gzip) {
+            result.data = gzip_compress(input);
+#ifdef HAVE_ZSTD
+        } else if (method == spec_compression::zstd) {
+            result.data = zstd_compress(input);
+#endif
+        } else {
+            result.data = move(input);
+        }
+        result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return result;
+    }, move(m_buffer)));
+
+    m_buffer = string();
+}
+
+void compressing_streambuf::write_oldest()
+{
+    auto start = chrono::steady_clock::now();
+    auto chunk = m_in_flight.front().get();
+    m_in_flight.pop_front();
+    m_wait_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    m_compress_seconds += chunk.seconds;
+    m_bytes_out += chunk.data.size();
+    m_out.write(chunk.data.data(), chunk.data.size());
+}
+
+void compression_stats::add(const compressing_streambuf &buf)
+{
+    bytes_in += buf.bytes_in();
+    bytes_out += buf.bytes_out();
+    compress_seconds += buf.compress_seconds();
+    wait_seconds += buf.wait_seconds();
+}
+
+void compressing_streambuf::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    drain_put_area();
+
+    // Even an empty stream needs one (empty) member to be a valid compressed file.
+    submit_chunk(m_bytes_in == 0 && m_method != spec_compression::none);
+    while (m_in_flight.size() > 0) {
+        write_oldest();
+    }
+    m_out.flush();
+}
@@ -0,0 +1,75 @@
+#include "content_hash.hpp"
+
+#include <fstream>
+
+using namespace std;
+
+namespace {
+    const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+    const uint64_t fnv_prime = 1099511628211ULL;
+}
+
+fnv1a_hash::fnv1a_hash()
+    : m_hash(fnv_offset_basis)
+{}
+
+void fnv1a_hash::add_bytes(const void *data, size_t size)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    auto h = m_hash;
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= fnv_prime;
+    }
+    m_hash = h;
+}
+
+void fnv1a_hash::add(uint64_t v)
+{
+    // Byte at a time so the hash does not depend on the machine's byte order
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = static_cast<unsigned char>(v >> (8 * i));
+    }
+    add_bytes(bytes, sizeof(bytes));
+}
+
+void fnv1a_hash::add(const string &s)
+{
+    add(static_cast<uint64_t>(s.size()));
+    add_bytes(s.data(), s.size());
+}
+
+void fnv1a_hash::add(const vector<string> &strings)
+{
+    add(static_cast<uint64_t>(strings.size()));
+    for (auto &&s : strings) {
+        add(s);
+    }
+}
+
+string fnv1a_hash::hex() const
+{
+    const char *digits = "0123456789abcdef";
+    string result(16, '0');
+    for (int i = 0; i < 16; i++) {
+        result[15 - i] = digits[(m_hash >> (4 * i)) & 0xf];
+    }
+    return result;
+}
+
+void add_file_contents(fnv1a_hash &hash, const string &path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        hash.add(string("<missing>"));
+        return;
+    }
+    hash.add(string("<file>"));
+    const int buf_size = 4096;
+    char buf[buf_size];
+    do {
+        in.read(&buf[0], buf_size);
+        hash.add_bytes(&buf[0], in.gcount());
+    } while (in.gcount() > 0);
+}
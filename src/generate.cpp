@@ -0,0 +1,1198 @@
+/// generate
+///
+/// The full pipeline that turns a list of seed classes into a yaml type
+/// specification: discovery of all referenced classes, pruning of the ones
+/// we can't emit, and finally emission.
+///
+#include "generate.hpp"
+#include "translate.hpp"
+#include "type_helpers.hpp"
+#include "xaod_helpers.hpp"
+#include "collections_info.hpp"
+#include "helper_files.hpp"
+#include "spec_writer.hpp"
+#include "hashing_spec_writer.hpp"
+#include "content_hash.hpp"
+#include "metadata_file_finder.hpp"
+#include "phase_timer.hpp"
+#include "trace.hpp"
+#include "translate_profile.hpp"
+#include "run_stats.hpp"
+#include "root_calls.hpp"
+
+#include "reflection_provider.hpp"
+#include "memory_reflection_provider.hpp"
+
+#include <iostream>
+#include <queue>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <tuple>
+#include <iterator>
+#include <fstream>
+#include <stdexcept>
+#include <memory>
+#include <sstream>
+#include <future>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+namespace {
+
+// Return true if it is ok to emit this particular class.
+// Check for specific bad types (e.g. string, types of vector, etc.).
+// No checking w.r.t. other lists is done.
+bool can_emit_class(const class_info &c_info) {
+    if (c_info.name_as_type.type_name == "string") {
+        return false;
+    }
+    if ((c_info.name_as_type.type_name != "vector") && (c_info.name_as_type.type_name != "ElementLink")) {
+        if (c_info.name_as_type.template_arguments.size() > 0) {
+            return false;
+        }
+    }
+    if (c_info.methods.size() == 0 && c_info.enums.size() == 0) {
+        return false;
+    }
+    return true;
+}
+
+// If this has template arguments, see if they are in the list of classes to emit
+bool check_template_arguments(const typename_info &info, const set<string> &classes_to_emit) {
+    // If this is an element link, we skip a level.
+    if (info.type_name == "ElementLink" && info.template_arguments[0].type_name == "DataVector") {
+        return check_template_arguments(info.template_arguments[0].template_arguments[0], classes_to_emit);
+    }
+
+    // Otherwise, we should look at everything.
+    for(auto && ta: info.template_arguments) {
+        if (ta.template_arguments.size() > 0) {
+            if (!check_template_arguments(ta, classes_to_emit)) {
+                return false;
+            }
+        } else {
+            if (classes_to_emit.find(ta.cpp_name) == classes_to_emit.end()) {
+                return false;
+            }
+        }
+    }
+
+    // Everything checks out!
+    return true;
+}
+
+set<string> _g_bad_root_libraries({
+    "RIO.so",
+    "Tree.so",
+    "Graf.so",
+    "Gui.so",
+    "Hist.so",
+    "TreePlayer.so",
+    "Gpad.so",
+});
+
+set<string> _g_bad_root_classes({
+    "TClonesArray",
+    "TArray",
+    "TArrayC",
+    "TArrayD",
+    "TArrayF",
+    "TArrayI",
+    "TAttAxis",
+    "TBrowser",
+    "TBroserImp",
+    "TBuffer",
+    "TBuffer3D",
+    "TClass",
+    "type_info"
+});
+
+// If this is a ROOT class that we do not want to have any part of
+// our results...
+bool is_root_only_class(const class_info &info) {
+    if (_g_bad_root_libraries.find(info.library_name) != _g_bad_root_libraries.end()) {
+        return false;
+    }
+    if (_g_bad_root_classes.find(info.name) != _g_bad_root_classes.end()) {
+        return false;
+    }
+    if (info.library_name.size() == 0 && info.name[0] == 'T') {
+        return false;
+    }
+    return true;
+}
+
+// Collections can be actual collections or just single items. Get
+// the type correctly in both those cases.
+string extract_container_iterator_type(const collection_info &c)
+{
+    switch (c.iterator_type_info.template_arguments.size()) {
+        case 0:
+            return c.iterator_type_info.cpp_name;
+            break;
+        
+        case 1:
+            return c.iterator_type_info.template_arguments[0].cpp_name;
+            break;
+        
+        default:
+            throw runtime_error("Do not know how to deal with the collection of iterator type " + c.iterator_type_info.cpp_name);
+    }
+}
+
+// These classes are known to be problematic
+set<string> _g_bad_classes{
+    "ROOT",
+    "SG",
+    "TObject",
+    "SG::auxid_set_t",
+    "DataModel_detail",
+};
+
+// Inspect the class name. There are just some classes we
+// should not be writing out under any circumstances.
+bool class_name_is_good(const string &c_name) {
+    return (_g_bad_classes.find(c_name) == _g_bad_classes.end()
+        && (c_name.find("Eigen") == c_name.npos)
+        && (c_name.find("SG::") == c_name.npos)
+        && (c_name.find("ROOT::Experimental") != 0)
+       );
+}
+
+// Non-owning view of the translated classes, indexed by class name. The
+// class_info objects themselves are owned by the list of done classes.
+typedef map<string, const class_info*> class_map_t;
+
+// Function to get the list of all types we are able to consider
+set<string> get_known_types(const set<string>& classes_to_emit, const class_map_t& class_map)
+{
+    set<string> known_types(classes_to_emit.begin(), classes_to_emit.end());
+    for (auto &&c_name : classes_to_emit)
+    {
+        auto class_info_ptr = class_map.find(c_name);
+        if (class_info_ptr != class_map.end()) {
+            auto &&class_info = *class_info_ptr->second;
+            auto defined_enums = class_enums(class_info);
+            known_types.insert(defined_enums.begin(), defined_enums.end());
+        }
+    }
+    return known_types;
+}
+
+// Find c_name as a class in the map, or if not, look one level up
+// to see if the class has an enum named.
+class_map_t::const_iterator find_class_or_enum(const string &c_name, const class_map_t &class_map)
+{
+    auto c_info = class_map.find(c_name);
+    if (c_info != class_map.end()) {
+        return c_info;
+    }
+
+    auto t = parse_typename(c_name);
+    if (t.namespace_list.size() > 0) {
+        auto parent_class_name = unqualified_typename(parent_class(t));
+        auto parent_class_itr = class_map.find(parent_class_name);
+        if (parent_class_itr == class_map.end()) {
+            return class_map.end();
+        }
+
+        // Check to see if c_name is an enum in this class
+        auto all_enums = class_enums(*parent_class_itr->second);
+        if (find(all_enums.begin(), all_enums.end(), c_name) != all_enums.end()) {
+            return parent_class_itr;
+        }
+    }
+
+    return class_map.end();
+}
+
+// Everything the discovery crawl found
+struct discovery_result {
+    // All classes that were translated (the owner of all class_info objects).
+    vector<class_info> done_classes;
+
+    // The seed classes that were translated, by their translated name.
+    set<string> classes_original_set_done;
+
+    // Classes the discovery limits kept out of the crawl
+    set<string> skipped_by_depth;
+    set<string> skipped_by_namespace;
+    set<string> skipped_by_library;
+};
+
+// Load all the libraries. Loading a library a second time is harmless.
+void load_libraries(const vector<string> &libraries)
+{
+    for (auto &&l_name : libraries)
+    {
+        scoped_trace_span span("load_library", "library", l_name);
+        auto status = reflection().load_library(l_name);
+        if (status < 0) {
+            cerr << "ERROR: Can't load library " << l_name << " - status: " << status << endl;
+        }
+    }
+}
+
+// Starting from the seed classes, translate everything they reference
+// (within the limits in the config).
+discovery_result discover_classes(const generate_config &config)
+{
+    discovery_result result;
+
+    // Each class is queued along with how many references away from a seed class it is.
+    queue<pair<string, int>> classes_to_do;
+    set<string> classes_original_set;
+    set<string> classes_done;
+
+    for (auto &&c_name : config.classes)
+    {
+        if (class_name_is_good(c_name)) {
+            add_count(run_counter::discovery_queue_pushes);
+            classes_to_do.push(make_pair(c_name, 0));
+            classes_original_set.insert(c_name);
+        }
+    }
+
+    // Queue a class found while crawling, unless a discovery limit says otherwise.
+    set<string> namespaces(config.discovery_namespaces.begin(), config.discovery_namespaces.end());
+    set<string> libraries(config.discovery_libraries.begin(), config.discovery_libraries.end());
+    auto queue_class = [&](const string &c_name, int depth) {
+        if (classes_done.find(c_name) != classes_done.end()) {
+            return;
+        }
+        if (config.max_discovery_depth >= 0 && depth > config.max_discovery_depth) {
+            result.skipped_by_depth.insert(c_name);
+            return;
+        }
+        if (namespaces.size() > 0 && !type_in_namespaces(parse_typename(c_name), namespaces)) {
+            result.skipped_by_namespace.insert(c_name);
+            return;
+        }
+        add_count(run_counter::discovery_queue_pushes);
+        classes_to_do.push(make_pair(c_name, depth));
+    };
+
+    // Translate the classes from the ROOT system to our internal system, starting from
+    // a given top level. Add all connected classes below that.
+    auto &&classes_original_set_done = result.classes_original_set_done;
+    auto &&done_classes = result.done_classes;
+    set<string> seen_namespace_additions;
+
+    while (classes_to_do.size() > 0) {
+        // Grab a class and mark it on the list
+        // so we don't try to re-run it.
+        auto raw_class_name(classes_to_do.front().first);
+        auto depth = classes_to_do.front().second;
+        classes_to_do.pop();
+        if (classes_done.find(raw_class_name) != classes_done.end()) {
+            add_count(run_counter::discovery_duplicates);
+            continue;
+        }
+        classes_done.insert(raw_class_name);
+
+        auto class_name = unqualified_type_name(raw_class_name);
+        if ((class_name != raw_class_name)
+            && (classes_done.find(class_name) != classes_done.end())) {
+                continue;
+            }
+        classes_done.insert(class_name);
+
+        // Only classes from the allowed libraries are kept (and crawled further). This is
+        // checked before translating, so a class outside them costs only the library lookup.
+        // translate_class gives vector and ElementLink no library, so they are always kept.
+        bool is_seed = classes_original_set.find(raw_class_name) != classes_original_set.end();
+        if (libraries.size() > 0 && !is_seed) {
+            auto t_name = parse_typename(class_name).type_name;
+            if (t_name != "vector" && t_name != "ElementLink") {
+                auto library_name = clean_so_name(reflection().class_library(class_name));
+                if (library_name.size() > 0 && libraries.find(library_name) == libraries.end()) {
+                    result.skipped_by_library.insert(class_name);
+                    continue;
+                }
+            }
+        }
+
+        // Translate the class
+        auto c = translate_class(class_name);
+
+        // Make sure to add all namespace qualifications in. This is
+        // because ROOT will store "global" enums in those namespaces,
+        // which is crazy but true.
+        const auto tn = c.name.size() == 0 ? parse_typename(class_name) : c.name_as_type;
+        string namespace_stem = "";
+        for (auto &&ns : tn.namespace_list)
+        {
+            if (namespace_stem.size() > 0) {
+                namespace_stem += "::";
+            }
+            namespace_stem += ns.cpp_name;
+            if (class_name_is_good(namespace_stem))
+            {
+                // Make sure it isn't on the classes_to_do list or the classes_done list first
+                if (classes_done.find(namespace_stem) == classes_done.end()
+                    && seen_namespace_additions.find(namespace_stem) == seen_namespace_additions.end()) {
+                    queue_class(namespace_stem, depth);
+                    seen_namespace_additions.insert(namespace_stem);
+                }
+            }
+        }
+
+        // If we translated it, look at all classes it referenced and
+        // add them to the list to translate.
+        if (c.name.size() > 0) {
+            // Mark this class done. From here on the class is owned by `done_classes`,
+            // and is never copied again.
+            done_classes.push_back(move(c));
+            auto &&c_done = done_classes.back();
+
+            // And if this is one of the original classes, mark it as done too
+            // with the full name we can do the lookup for.
+            if (is_seed) {
+                classes_original_set_done.insert(c_done.name);
+            }
+
+            // Add enum's to the `classes_done` list so we don't try to translate them again.
+            auto defined_enums = class_enums(c_done);
+            classes_done.insert(defined_enums.begin(), defined_enums.end());
+
+            // Add any referenced classes to our class list!
+            for (auto &&c_name : referenced_types(c_done))
+            {
+                if (class_name_is_good(c_name)) {
+                    queue_class(c_name, depth + 1);
+                }
+            }
+
+            // And add any template references in this class name
+            auto t_info = parse_typename(class_name);
+            for (auto &&t_name : type_referenced_types(t_info))
+            {
+                auto c_name = unqualified_type_name(t_name);
+                if (class_name_is_good(c_name))
+                {
+                    queue_class(c_name, depth + 1);
+                }
+            }
+
+        } else {
+            // The class might actually be an enum, and the parent might
+            // be something we can translate. So - parse off one level down in the
+            // type name, and add it to the list, and see what happens.
+            auto t = parse_typename(class_name);
+            if (t.namespace_list.size() > 0) {
+                auto parent_class_name = unqualified_typename(parent_class(t));
+                if (class_name_is_good(parent_class_name)) {
+                    queue_class(parent_class_name, depth);
+                }
+            }
+        }
+    }
+
+    // Something skipped early on might have been reached by a shorter path later.
+    for (auto skipped : {&result.skipped_by_depth, &result.skipped_by_namespace}) {
+        for (auto itr = skipped->begin(); itr != skipped->end();) {
+            if (classes_done.find(*itr) != classes_done.end()) {
+                itr = skipped->erase(itr);
+            } else {
+                itr++;
+            }
+        }
+    }
+
+    return result;
+}
+
+// Find all the top level collections (containers and single objects).
+vector<collection_info> find_all_collections(const vector<class_info> &done_classes)
+{
+    // Get the list of containers from the classes. These will be top level collections
+    // stored in the data.
+    auto all_collections = find_collections(done_classes);
+    auto single_collections = get_single_object_collections(done_classes);
+    move(single_collections.begin(), single_collections.end(),
+        back_inserter(all_collections));
+    return all_collections;
+}
+
+// Find all classes connected to the collections and the seed classes. These
+// are the candidates for emission.
+set<string> find_classes_to_emit(const vector<collection_info> &all_collections, const set<string> &classes_original_set_done, const class_map_t &class_map)
+{
+    // Start by looking at the classes that are connected to our
+    // containers.
+    queue<string> classes_to_do;
+    set<string> classes_done;
+    set<string> classes_to_emit;
+    for (auto &&c : all_collections)
+    {
+        auto c_name (extract_container_iterator_type(c));
+        if (class_name_is_good(c_name)) {
+            classes_to_do.push(c_name);
+        }
+    }
+
+    // Next, look at any of the classes that were on the original list
+    for (auto &&c_name : classes_original_set_done)
+    {
+        classes_to_do.push(c_name);
+    }
+
+    // With that list of classes, lets find everything connected.
+    while (!classes_to_do.empty()) {
+        string c_name(unqualified_type_name(classes_to_do.front()));
+        classes_to_do.pop();
+        if (classes_done.find(c_name) != classes_done.end()) {
+            continue;
+        }
+        classes_done.insert(c_name);
+
+        // Find the class or enum
+        auto c_info = find_class_or_enum(c_name, class_map);
+        // auto c_info = class_map.find(c_name);
+        if (c_info == class_map.end()) {
+            continue;
+        }
+
+        // If we can dump the class, then we should!
+        if (can_emit_class(*c_info->second)) {
+            classes_to_emit.insert(c_info->first);
+        } else {
+            cerr << "ERROR: Class " << c_name << " fails `can_emit_class`: not emitted." << endl;
+        }
+
+        // Now, add referenced classes to the queue
+        auto reffed_classes = referenced_types(*c_info->second);
+        for (auto &&c_ref : reffed_classes)
+        {
+            if (class_name_is_good(c_ref)) {
+                classes_to_do.push(c_ref);
+            }
+        }
+    }
+
+    // Add some of the default types that need no introduction
+    classes_to_emit.insert("bool");
+    classes_to_emit.insert("double");
+    classes_to_emit.insert("float");
+    classes_to_emit.insert("short");
+    classes_to_emit.insert("unsigned short");
+    classes_to_emit.insert("int");
+    classes_to_emit.insert("int8_t");
+    classes_to_emit.insert("int16_t");
+    classes_to_emit.insert("int32_t");
+    classes_to_emit.insert("int64_t");
+    classes_to_emit.insert("uint8_t");
+    classes_to_emit.insert("uint16_t");
+    classes_to_emit.insert("uint64_t");
+    classes_to_emit.insert("uint");
+    classes_to_emit.insert("unsigned int");
+    classes_to_emit.insert("char");
+    classes_to_emit.insert("unsigned char");
+    classes_to_emit.insert("size_t");
+    classes_to_emit.insert("long");
+    classes_to_emit.insert("unsigned long");
+    classes_to_emit.insert("long long");
+    classes_to_emit.insert("unsigned long long");
+    classes_to_emit.insert("string");
+
+    return classes_to_emit;
+}
+
+// Remove classes we can't emit until we reach a stable set.
+void prune_classes_to_emit(set<string> &classes_to_emit, const class_map_t &class_map)
+{
+    // Now, we need to loop through all of these things until we get a stable set of classes that we can emit.
+    // This is painful, because there could be classes that look good, but contain no valid methods - so no need
+    // to emit them. Cross them off the list, and another class' method is no longer interesting, in which case, that
+    // has to be crossed. So we keep looping until we reach a stable set of classes.
+    bool modified = true;
+    while (modified)
+    {
+        scoped_trace_span span("prune_pass", "prune");
+        add_count(run_counter::prune_passes);
+        modified = false;
+        set<string> bad_classes;
+
+        // Get a list of all types we are able to consider by merging the classes_to_emit and the enums that
+        // those classes define together.
+        auto known_types = get_known_types(classes_to_emit, class_map);
+        
+        // Now, what classes/methods can't be emitted due to lacking definitions?
+        for (auto &&c_name : classes_to_emit)
+        {
+            auto class_info_ptr = class_map.find(c_name);
+            if (class_info_ptr != class_map.end()) {
+                auto &&class_info = *class_info_ptr->second;
+                if (!check_template_arguments(class_info.name_as_type, known_types)) {
+                    bad_classes.insert(c_name);
+                    cerr << "ERROR: Class " << c_name << " not translated: template arguments were bad." << endl;
+                }
+                if (!is_root_only_class(class_info)) {
+                    cerr << "INFO: Class " << c_name << " not translated: ROOT only class." << endl;
+                    bad_classes.insert(c_name);
+                }
+            }
+        }
+        if (bad_classes.size() > 0) {
+            modified = true;
+            for (auto &&b_c : bad_classes)
+            {
+                classes_to_emit.erase(b_c);
+            }
+        }
+    }
+}
+
+// Turn the collections into spec records.
+vector<spec_collection> build_spec_collections(const vector<collection_info> &collections)
+{
+    vector<spec_collection> result;
+    for (auto &&c : collections)
+    {
+        spec_collection s_c;
+        s_c.collection_name = c.name;
+        s_c.cpp_item_type = extract_container_iterator_type(c);
+        s_c.python_item_type = normalized_type_name(s_c.cpp_item_type);
+        s_c.cpp_container_type = c.type_info.cpp_name;
+        s_c.python_container_type = normalized_type_name(c.iterator_type_info);
+        s_c.include_file = c.include_file;
+        s_c.link_libraries = c.link_libraries;
+
+        auto meta_data_itr = _g_collection_config.find(c.name);
+        s_c.has_metadata = meta_data_itr != _g_collection_config.end();
+        if (s_c.has_metadata) {
+            s_c.metadata = meta_data_itr->second;
+        }
+
+        result.push_back(move(s_c));
+    }
+
+    // Canonical order
+    sort(result.begin(), result.end(), [](const spec_collection &a, const spec_collection &b) {
+        return a.collection_name < b.collection_name;
+    });
+    return result;
+}
+
+// Convert a list of method arguments into spec records.
+vector<spec_argument> build_spec_arguments(const vector<method_arg> &arguments)
+{
+    vector<spec_argument> result;
+    result.reserve(arguments.size());
+    for (auto &&arg : arguments)
+    {
+        result.push_back(spec_argument{arg.name, normalized_type_name(arg.full_typename)});
+    }
+    return result;
+}
+
+// Compare argument lists by their types, then their names
+bool arguments_come_before(const vector<spec_argument> &a, const vector<spec_argument> &b)
+{
+    return lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+        [](const spec_argument &x, const spec_argument &y) {
+            return tie(x.type, x.name) < tie(y.type, y.name);
+        });
+}
+
+// The canonical order of methods in a class: by name, then overloads by their argument
+// types, return type, and everything else, so the order never depends on the order ROOT
+// (or the hand-added methods) listed them in.
+bool method_comes_before(const spec_method &a, const spec_method &b)
+{
+    if (a.name != b.name) {
+        return a.name < b.name;
+    }
+    if (arguments_come_before(a.arguments, b.arguments)) {
+        return true;
+    }
+    if (arguments_come_before(b.arguments, a.arguments)) {
+        return false;
+    }
+    if (a.return_type != b.return_type) {
+        return a.return_type < b.return_type;
+    }
+    if (arguments_come_before(a.parameter_arguments, b.parameter_arguments)) {
+        return true;
+    }
+    if (arguments_come_before(b.parameter_arguments, a.parameter_arguments)) {
+        return false;
+    }
+    return tie(a.param_helper, a.param_type_callback) < tie(b.param_helper, b.param_type_callback);
+}
+
+// Build the spec record for a class. Methods that use types we can't emit are
+// dropped (and reported to `log`), and those types are recorded in `failed_types`. Methods
+// declared by one of the classes in `skip_declared_in` are left out silently.
+//
+// Only plain data is used (no ROOT), so classes can be built on several threads at once
+// as long as each has its own cache.
+spec_class build_spec_class(const class_info &c_emit, understood_type_cache &known_types_cache,
+    map<string, vector<string>> &failed_types, ostream &log, const set<string> &skip_declared_in = {})
+{
+    spec_class s_c;
+    s_c.python_name = normalized_type_name(c_emit.name_as_type);
+    s_c.cpp_name = c_emit.name_as_type.cpp_name;
+
+    if (c_emit.library_name.size() > 0 && c_emit.library_name.find(".so") == string::npos) {
+        s_c.library = c_emit.library_name;
+    }
+
+    s_c.is_container = c_emit.is_container;
+    if (c_emit.is_container) {
+        auto &&container_typename = c_emit.container_type;
+        s_c.is_container_of_cpp = container_typename.cpp_name;
+        s_c.is_container_of_python = normalized_type_name(container_typename);
+    }
+
+    s_c.include_file = c_emit.include_file;
+    s_c.also_behaves_like = c_emit.class_behaviors;
+    // Enums (and their values) go out in canonical order
+    s_c.enums = c_emit.enums;
+    sort(s_c.enums.begin(), s_c.enums.end(), [](const enum_info &a, const enum_info &b) {
+        return a.name < b.name;
+    });
+    for (auto &&e : s_c.enums) {
+        sort(e.values.begin(), e.values.end(), [](const pair<string, int> &a, const pair<string, int> &b) {
+            return a.second < b.second || (a.second == b.second && a.first < b.first);
+        });
+    }
+
+    auto &&known_types = known_types_cache.known_types();
+    for (auto &&meth : c_emit.methods)
+    {
+        if (meth.declaring_class.size() > 0 && skip_declared_in.find(meth.declaring_class) != skip_declared_in.end()) {
+            continue;
+        }
+        if (is_understood_method(meth, known_types_cache)) {
+            spec_method s_m;
+            s_m.name = meth.name;
+            s_m.return_type = parse_typename(meth.return_type).cpp_name;
+            s_m.arguments = build_spec_arguments(meth.arguments);
+            s_m.parameter_arguments = build_spec_arguments(meth.parameter_arguments);
+            s_m.param_helper = meth.parameter_type_helper;
+            s_m.param_type_callback = meth.param_method_callback;
+            s_c.methods.push_back(move(s_m));
+        } else {
+            auto method_args(referenced_types(meth));
+            // Do not warn when return type is void - this is just how we work
+            // in a functional world for now (e.g. by design).
+            if (meth.return_type.size() != 0) {
+                bool first = true;
+                log << "ERROR: Cannot emit method " << c_emit.name << "::" << meth.name << " - some types not known: ";
+                for (const auto& arg : method_args) {
+                    if (known_types.find(arg) == known_types.end()) {
+                        if (!first) {
+                            log << ", ";
+                        }
+                        first = false;
+                        log << arg;
+                        failed_types[arg].push_back(c_emit.name + "::" + meth.name);
+                    }
+                }
+                log << endl;
+            }
+        }
+    }
+
+    // Methods in canonical order. The same name can show up more than once (overloads, or
+    // an added by hand method), so those are ordered by their signatures.
+    sort(s_c.methods.begin(), s_c.methods.end(), method_comes_before);
+
+    return s_c;
+}
+
+// A class ready to be written, along with everything found while building it.
+struct built_class {
+    spec_class record;
+    map<string, vector<string>> failed_types;
+    string log;
+    size_t n_inherited_methods = 0;
+};
+
+// Build the record for one class (see emit_classes).
+built_class build_class(const class_info &c_emit, const class_map_t &class_map, const set<string> &emitted_names,
+    understood_type_cache &known_types_cache, bool declared_methods_only)
+{
+    scoped_trace_span span("build_class", "emit", c_emit.name);
+    built_class result;
+    ostringstream log;
+    if (!declared_methods_only) {
+        result.record = build_spec_class(c_emit, known_types_cache, result.failed_types, log);
+    } else {
+        set<string> emitted_ancestors;
+        auto nearest = nearest_emitted_ancestors(c_emit, class_map, emitted_names, emitted_ancestors);
+        result.record = build_spec_class(c_emit, known_types_cache, result.failed_types, log, emitted_ancestors);
+        for (auto &&b : nearest)
+        {
+            result.record.inherits_from.push_back(class_map.at(b)->name_as_type.cpp_name);
+        }
+
+        result.n_inherited_methods = count_if(c_emit.methods.begin(), c_emit.methods.end(), [&emitted_ancestors](const method_info &m) {
+            return emitted_ancestors.find(m.declaring_class) != emitted_ancestors.end();
+        });
+    }
+    result.log = log.str();
+    return result;
+}
+
+// Write out the classes, one at a time. Any types that prevented a method from being
+// emitted are recorded in `failed_types`.
+//
+// With `declared_methods_only`, a method is only written on the class that declares it,
+// as long as that class is emitted too. Derived classes list their closest emitted bases
+// in `inherits_from` instead.
+//
+// With more than one thread the class records are built in parallel, but they (and any
+// messages) are still written one at a time in canonical order, so the output is the same.
+void emit_classes(spec_writer &out, const set<string> &classes_to_emit, const class_map_t &class_map,
+    const set<string> &known_types, map<string, vector<string>> &failed_types, bool declared_methods_only,
+    int threads)
+{
+    // Find everything that will make it into the spec
+    vector<const class_info*> emitted;
+    set<string> emitted_names;
+    for (auto &&c : classes_to_emit)
+    {
+        string c_name(unqualified_type_name(c));
+
+        // Find the class
+        auto c_info = class_map.find(c_name);
+        if (c_info == class_map.end()) {
+            cerr << "ERROR: Ready to emit class " << c_name << " but it is not in the class map." << endl;
+            continue;
+        }
+
+        if (!can_emit_class(*c_info->second)) {
+            cerr << "ERROR: Ready to emit class " << c_name << " but it is on our list of classes to block." << endl;
+            continue;
+        }
+
+        if (emitted_names.insert(c_info->first).second) {
+            emitted.push_back(c_info->second);
+        }
+    }
+
+    // Canonical order is by C++ name
+    sort(emitted.begin(), emitted.end(), [](const class_info *a, const class_info *b) {
+        return a->name_as_type.cpp_name < b->name_as_type.cpp_name
+            || (a->name_as_type.cpp_name == b->name_as_type.cpp_name && a->name < b->name);
+    });
+
+    if (threads <= 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    threads = min(static_cast<size_t>(threads), max(static_cast<size_t>(1), emitted.size()));
+
+    // Each worker takes the next class nobody has started yet. Results are handed
+    // back through one promise per class so they can be written in order.
+    vector<promise<built_class>> built(emitted.size());
+    atomic<size_t> next_class(0);
+    auto worker = [&]() {
+        understood_type_cache known_types_cache(known_types);
+        for (size_t i = next_class++; i < emitted.size(); i = next_class++)
+        {
+            try {
+                built[i].set_value(build_class(*emitted[i], class_map, emitted_names, known_types_cache, declared_methods_only));
+            } catch (...) {
+                built[i].set_exception(current_exception());
+            }
+        }
+    };
+
+    vector<future<void>> workers;
+    if (threads > 1) {
+        for (int i = 0; i < threads; i++) {
+            workers.push_back(async(launch::async, worker));
+        }
+    } else {
+        worker();
+    }
+
+    out.begin_classes();
+
+    size_t n_methods = 0, n_inherited_methods = 0;
+    for (auto &&b : built)
+    {
+        auto c = b.get_future().get();
+        cerr << c.log;
+        for (auto &&f : c.failed_types)
+        {
+            auto &&methods = failed_types[f.first];
+            methods.insert(methods.end(), f.second.begin(), f.second.end());
+        }
+        n_methods += c.record.methods.size();
+        n_inherited_methods += c.n_inherited_methods;
+
+        out.write_class(c.record);
+    }
+
+    out.end_classes();
+
+    if (declared_methods_only) {
+        cerr << "INFO: Wrote " << n_methods << " methods; " << n_inherited_methods
+             << " inherited methods were left to the classes that declare them." << endl;
+    }
+}
+
+// Hash of everything that goes into making the spec: the release, the
+// configuration, and the metadata files.
+string inputs_hash(const generate_config &config, const string &atlas_release, const metadata_file_finder &finder)
+{
+    fnv1a_hash hash;
+    hash.add(atlas_release);
+    hash.add(config.classes);
+    hash.add(config.libraries);
+    hash.add(static_cast<uint64_t>(static_cast<int64_t>(config.max_discovery_depth)));
+    hash.add(config.discovery_namespaces);
+    hash.add(config.discovery_libraries);
+    hash.add(static_cast<uint64_t>(config.format));
+    hash.add(static_cast<uint64_t>(config.declared_methods_only));
+    hash.add(config.output_directory.size() > 0 ? static_cast<uint64_t>(config.shard_by) + 1 : 0);
+    hash.add(static_cast<uint64_t>(config.helper_files.as_text));
+    if (config.helper_files.reference_spec.size() > 0) {
+        add_file_contents(hash, config.helper_files.reference_spec);
+    }
+    if (config.reflection_file.size() > 0) {
+        add_file_contents(hash, config.reflection_file);
+    }
+
+    for (auto &&path : helper_file_paths(finder))
+    {
+        add_file_contents(hash, path);
+    }
+    add_file_contents(hash, finder("extra_metadata.yaml"));
+    return hash.hex();
+}
+
+// Report how well the compression did
+void report_compression(const compression_stats &stats)
+{
+    cerr << "INFO: Compressed " << stats.bytes_in << " bytes to " << stats.bytes_out << " bytes";
+    if (stats.bytes_in > 0) {
+        cerr << " (" << (100.0 * stats.bytes_out / stats.bytes_in) << "%)";
+    }
+    cerr << "; " << stats.compress_seconds << " s compressing, "
+         << stats.wait_seconds << " s waiting on the compressor." << endl;
+}
+
+// Build the config block
+spec_config build_spec_config(const string &atlas_release, bool declared_methods_only)
+{
+    spec_config config;
+    config.atlas_release = atlas_release;
+    config.declared_methods_only = declared_methods_only;
+    config.dataset_types.push_back("PHYS");
+    if (atlas_release.find("21") == string::npos) {
+        config.dataset_types.push_back("PHYSLITE");
+    }
+    return config;
+}
+
+// Use a different reflection provider until this goes out of scope
+class scoped_reflection_provider {
+public:
+    scoped_reflection_provider(shared_ptr<reflection_provider> provider)
+        : m_previous(set_reflection_provider(provider))
+    {}
+    ~scoped_reflection_provider() {
+        set_reflection_provider(m_previous);
+    }
+private:
+    shared_ptr<reflection_provider> m_previous;
+};
+
+// Send trace spans to a recorder until this goes out of scope
+class scoped_active_trace {
+public:
+    scoped_active_trace(trace_recorder *trace)
+        : m_previous(set_active_trace(trace))
+    {}
+    ~scoped_active_trace() {
+        set_active_trace(m_previous);
+    }
+private:
+    trace_recorder *m_previous;
+};
+
+// Send class translation timings to a profile until this goes out of scope
+class scoped_translate_profile {
+public:
+    scoped_translate_profile(translate_profile *profile)
+        : m_previous(set_active_translate_profile(profile))
+    {}
+    ~scoped_translate_profile() {
+        set_active_translate_profile(m_previous);
+    }
+private:
+    translate_profile *m_previous;
+};
+
+// Dump the failed types and their associated methods
+void report_failed_types(const map<string, vector<string>> &failed_types)
+{
+    cerr << "Summary of failed types and their methods:" << endl;
+    vector<pair<string, vector<string>>> sorted_failed_types(failed_types.begin(), failed_types.end());
+    sort(sorted_failed_types.begin(), sorted_failed_types.end(), [](const auto& a, const auto& b) {
+        return a.second.size() > b.second.size();
+    });
+    for (const auto& [type, methods] : sorted_failed_types) {
+        cerr << "Type: " << type << ", Number of methods: " << methods.size() << endl;
+        for (const auto& method : methods) {
+            cerr << "  " << method << endl;
+        }
+    }
+}
+
+}
+
+void generate_spec(const generate_config &config, ostream &out)
+{
+    // Tracing is only turned on if asked for
+    unique_ptr<trace_recorder> trace;
+    unique_ptr<scoped_active_trace> tracing;
+    if (config.trace_file.size() > 0) {
+        trace = make_unique<trace_recorder>();
+        tracing = make_unique<scoped_active_trace>(trace.get());
+    }
+
+    auto counters_at_start = read_run_counters();
+    auto root_calls_at_start = read_root_call_totals();
+
+    translate_profile class_profile;
+    unique_ptr<scoped_translate_profile> profiling;
+    if (config.slow_classes > 0) {
+        profiling = make_unique<scoped_translate_profile>(&class_profile);
+    }
+
+    phase_timer timer;
+
+    // The release is needed to find the metadata files - make sure we have it
+    // before doing any work.
+    string atlas_release (config.atlas_release);
+    if (atlas_release.size() == 0) {
+        auto env_release = getenv("AtlasVersion");
+        if (env_release == nullptr) {
+            throw runtime_error("No ATLAS release given, and AtlasVersion is not set.");
+        }
+        atlas_release = env_release;
+    }
+    metadata_file_finder m_finder (atlas_release, config.metadata_prefix);
+
+    // Where the class information comes from
+    unique_ptr<scoped_reflection_provider> replay, record;
+    if (config.reflection_file.size() > 0) {
+        replay = make_unique<scoped_reflection_provider>(make_shared<memory_reflection_provider>(config.reflection_file));
+    } else {
+        scoped_phase phase(timer, "load libraries");
+        load_libraries(config.libraries);
+    }
+    shared_ptr<recording_reflection_provider> recorder;
+    if (config.record_reflection_file.size() > 0) {
+        recorder = make_shared<recording_reflection_provider>(current_reflection_provider());
+        record = make_unique<scoped_reflection_provider>(recorder);
+    }
+
+    // A previous run in this process may have cached typedefs from before these
+    // libraries were loaded.
+    clear_typedef_cache();
+
+    // Translate everything connected to the seed classes
+    discovery_result discovered;
+    {
+        scoped_phase phase(timer, "discovery");
+        discovered = discover_classes(config);
+    }
+    auto &&done_classes = discovered.done_classes;
+    if (config.max_discovery_depth >= 0 || config.discovery_namespaces.size() > 0 || config.discovery_libraries.size() > 0) {
+        cerr << "INFO: Discovery skipped "
+             << discovered.skipped_by_depth.size() + discovered.skipped_by_namespace.size() + discovered.skipped_by_library.size()
+             << " classes: " << discovered.skipped_by_depth.size() << " beyond the depth limit, "
+             << discovered.skipped_by_namespace.size() << " outside the allowed namespaces, "
+             << discovered.skipped_by_library.size() << " outside the allowed libraries." << endl;
+    }
+
+    // Look at the loaded type defs, and add aliases.
+    {
+        scoped_phase phase(timer, "type aliases");
+        fixup_type_aliases(done_classes);
+    }
+
+    // Fix up type defs. We have to wait to do this b.c. otherwise
+    // ROOT won't load the typedefs
+    {
+        scoped_phase phase(timer, "typedefs");
+        fixup_type_defs(done_classes);
+    }
+
+    // Now that the method types are final, decide once which classes are containers.
+    {
+        scoped_phase phase(timer, "classify containers");
+        classify_containers(done_classes);
+    }
+
+    // Build a class map. `done_classes` is not modified after this point, so
+    // the map can just point into it.
+    class_map_t class_map;
+    for (auto &&c : done_classes)
+    {
+        class_map[c.name] = &c;
+    }
+
+    vector<collection_info> all_collections;
+    {
+        scoped_phase phase(timer, "collections");
+        all_collections = find_all_collections(done_classes);
+    }
+
+    // Start from the collections and the seed classes, and find everything we could emit.
+    set<string> classes_to_emit;
+    set<string> known_types;
+    vector<collection_info> collections;
+    {
+        scoped_phase phase(timer, "pruning");
+        classes_to_emit = find_classes_to_emit(all_collections, discovered.classes_original_set_done, class_map);
+        prune_classes_to_emit(classes_to_emit, class_map);
+
+        // Get the final list of known types we can work with.
+        known_types = get_known_types(classes_to_emit, class_map);
+
+        // Finally, go through the collections and keep only the ones where we are
+        // dumping out the classes they contain.
+        copy_if(all_collections.begin(), all_collections.end(), back_insert_iterator(collections),
+            [&classes_to_emit](const collection_info &c_info) {
+                string collection_iterator_typename(extract_container_iterator_type(c_info));
+                return find_if(classes_to_emit.begin(), classes_to_emit.end(), [&collection_iterator_typename](const string &cl_name){
+                    return cl_name == collection_iterator_typename;
+                }) != classes_to_emit.end();
+            });
+    }
+
+    // Dump them all out. Each piece goes to the output as soon as it is ready.
+    unique_ptr<spec_writer> writer_ptr;
+    unique_ptr<compressing_ostream> compressed_out;
+    unique_ptr<counting_ostream> counted_out;
+    sharded_spec_writer *sharded_writer = nullptr;
+    if (config.output_directory.size() > 0) {
+        auto sharded = make_unique<sharded_spec_writer>(config.output_directory, config.format, config.shard_by,
+            config.compression, config.compression_threads);
+        sharded_writer = sharded.get();
+        writer_ptr = move(sharded);
+    } else if (config.compression != spec_compression::none) {
+        compressed_out = make_unique<compressing_ostream>(out, config.compression, config.compression_threads);
+        counted_out = make_unique<counting_ostream>(*compressed_out);
+        writer_ptr = make_spec_writer(config.format, *counted_out);
+    } else {
+        counted_out = make_unique<counting_ostream>(out);
+        writer_ptr = make_spec_writer(config.format, *counted_out);
+    }
+    auto extra_metadata = m_finder("extra_metadata.yaml");
+    hashing_spec_writer writer(*writer_ptr, extra_metadata);
+    {
+        scoped_phase phase(timer, "emit collections");
+        writer.write_collections(build_spec_collections(collections));
+    }
+
+    map<string, vector<string>> failed_types;
+    {
+        scoped_phase phase(timer, "emit classes");
+        emit_classes(writer, classes_to_emit, class_map, known_types, failed_types, config.declared_methods_only,
+            config.emit_threads);
+    }
+
+    // Do the helper files
+    {
+        scoped_phase phase(timer, "helper files");
+        emit_helper_files(writer, m_finder, config.helper_files);
+    }
+
+    {
+        scoped_phase phase(timer, "finish");
+
+        // Dump some parameters about the running. The content hash is filled in by the writer.
+        auto config_block = build_spec_config(atlas_release, config.declared_methods_only);
+        config_block.inputs_hash = inputs_hash(config, atlas_release, m_finder);
+        writer.write_config(config_block);
+
+        // Close it off and append the extra metadata file
+        writer.finish(extra_metadata);
+        if (counted_out) {
+            counted_out->flush();
+        }
+
+        if (config.compression != spec_compression::none) {
+            compression_stats stats;
+            if (compressed_out) {
+                compressed_out->finish();
+                stats.add(compressed_out->compressor());
+            } else if (sharded_writer != nullptr) {
+                stats = sharded_writer->compression();
+            }
+            report_compression(stats);
+        }
+    }
+
+    if (recorder) {
+        ofstream recording(config.record_reflection_file);
+        if (!recording) {
+            throw runtime_error("Unable to open " + config.record_reflection_file + " to write the reflection recording.");
+        }
+        recorder->recorded().write(recording);
+    }
+
+    report_failed_types(failed_types);
+
+    if (profiling) {
+        profiling.reset();
+        cerr << "INFO: Time to translate each class:" << endl;
+        write_translate_histogram(cerr, class_profile);
+        cerr << "INFO: The " << config.slow_classes << " slowest classes to translate:" << endl;
+        write_slowest_classes(cerr, class_profile, config.slow_classes);
+    }
+
+    if (config.report_stats || config.stats_file.size() > 0) {
+        auto counters = read_run_counters() - counters_at_start;
+        auto root_calls = read_root_call_totals() - root_calls_at_start;
+        if (config.report_stats) {
+            cerr << "INFO: Operation counts:" << endl;
+            write_run_counters(cerr, counters);
+            cerr << "INFO: Calls into ROOT:" << endl;
+            write_root_call_table(cerr, root_calls);
+        }
+        if (config.stats_file.size() > 0) {
+            ofstream stats(config.stats_file);
+            if (!stats) {
+                throw runtime_error("Unable to open " + config.stats_file + " to write the operation counts.");
+            }
+            stats << "{\"counters\": ";
+            write_run_counters_json(stats, counters);
+            stats << ", \"root_calls\": ";
+            write_root_call_json(stats, root_calls);
+            stats << "}" << endl;
+        }
+    }
+
+    if (config.report_timings) {
+        cerr << "INFO: Time spent in each phase:" << endl;
+        write_phase_table(cerr, timer);
+    }
+    if (config.timings_file.size() > 0) {
+        ofstream timings(config.timings_file);
+        if (!timings) {
+            throw runtime_error("Unable to open " + config.timings_file + " to write the timings.");
+        }
+        write_phase_json(timings, timer);
+    }
+
+    if (trace) {
+        tracing.reset();
+        ofstream trace_out(config.trace_file);
+        if (!trace_out) {
+            throw runtime_error("Unable to open " + config.trace_file + " to write the trace.");
+        }
+        trace->write(trace_out);
+    }
+}
@@ -0,0 +1,140 @@
+#include "hashing_spec_writer.hpp"
+
+using namespace std;
+
+namespace {
+    void add_arguments(fnv1a_hash &hash, const vector<spec_argument> &arguments) {
+        hash.add(static_cast<uint64_t>(arguments.size()));
+        for (auto &&arg : arguments) {
+            hash.add(arg.name);
+            hash.add(arg.type);
+        }
+    }
+
+    void add_parameter(fnv1a_hash &hash, const parameter_info &p) {
+        hash.add(p.name);
+        hash.add(p.p_type);
+        hash.add(p.p_default);
+    }
+
+    void add_parameters(fnv1a_hash &hash, const vector<parameter_info_extra> &parameters) {
+        hash.add(static_cast<uint64_t>(parameters.size()));
+        for (auto &&p : parameters) {
+            add_parameter(hash, p);
+            hash.add(static_cast<uint64_t>(p.variable_actions.size()));
+            for (auto &&a : p.variable_actions) {
+                hash.add(a.value);
+                hash.add(a.metadata_names);
+                hash.add(a.bank_rename);
+            }
+        }
+    }
+}
+
+// The extra metadata is only written after the config block, so it is hashed up front.
+hashing_spec_writer::hashing_spec_writer(spec_writer &out, const string &extra_metadata_path)
+    : m_out(out)
+{
+    m_hash.add(string("extra_metadata"));
+    add_file_contents(m_hash, extra_metadata_path);
+}
+
+void hashing_spec_writer::write_collections(const vector<spec_collection> &collections)
+{
+    m_hash.add(string("collections"));
+    m_hash.add(static_cast<uint64_t>(collections.size()));
+    for (auto &&c : collections) {
+        m_hash.add(c.collection_name);
+        m_hash.add(c.cpp_item_type);
+        m_hash.add(c.python_item_type);
+        m_hash.add(c.cpp_container_type);
+        m_hash.add(c.python_container_type);
+        m_hash.add(c.include_file);
+        m_hash.add(c.link_libraries);
+        m_hash.add(static_cast<uint64_t>(c.has_metadata));
+        if (c.has_metadata) {
+            m_hash.add(c.metadata.method_callback);
+            add_parameters(m_hash, c.metadata.parameters);
+            add_parameters(m_hash, c.metadata.extra_parameters);
+        }
+    }
+    m_out.write_collections(collections);
+}
+
+void hashing_spec_writer::begin_classes()
+{
+    m_hash.add(string("classes"));
+    m_out.begin_classes();
+}
+
+void hashing_spec_writer::write_class(const spec_class &c)
+{
+    m_hash.add(c.python_name);
+    m_hash.add(c.cpp_name);
+    m_hash.add(c.library);
+    m_hash.add(static_cast<uint64_t>(c.is_container));
+    m_hash.add(c.is_container_of_cpp);
+    m_hash.add(c.is_container_of_python);
+    m_hash.add(c.include_file);
+    m_hash.add(c.also_behaves_like);
+    m_hash.add(c.inherits_from);
+
+    m_hash.add(static_cast<uint64_t>(c.enums.size()));
+    for (auto &&e : c.enums) {
+        m_hash.add(e.name);
+        m_hash.add(static_cast<uint64_t>(e.values.size()));
+        for (auto &&v : e.values) {
+            m_hash.add(v.first);
+            m_hash.add(static_cast<uint64_t>(static_cast<int64_t>(v.second)));
+        }
+    }
+
+    m_hash.add(static_cast<uint64_t>(c.methods.size()));
+    for (auto &&m : c.methods) {
+        m_hash.add(m.name);
+        m_hash.add(m.return_type);
+        add_arguments(m_hash, m.arguments);
+        add_arguments(m_hash, m.parameter_arguments);
+        m_hash.add(m.param_helper);
+        m_hash.add(m.param_type_callback);
+    }
+
+    m_out.write_class(c);
+}
+
+void hashing_spec_writer::end_classes()
+{
+    m_out.end_classes();
+}
+
+void hashing_spec_writer::begin_files()
+{
+    m_hash.add(string("files"));
+    m_out.begin_files();
+}
+
+void hashing_spec_writer::write_file(const spec_file &f)
+{
+    m_hash.add(f.name);
+    m_hash.add(f.init_lines);
+    m_hash.add(f.contents);
+    m_hash.add(f.reference);
+    m_out.write_file(f);
+}
+
+void hashing_spec_writer::end_files()
+{
+    m_out.end_files();
+}
+
+void hashing_spec_writer::write_config(const spec_config &config)
+{
+    auto hashed_config(config);
+    hashed_config.content_hash = m_hash.hex();
+    m_out.write_config(hashed_config);
+}
+
+void hashing_spec_writer::finish(const string &extra_metadata_path)
+{
+    m_out.finish(extra_metadata_path);
+}
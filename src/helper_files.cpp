@@ -1,7 +1,14 @@
 #include "helper_files.hpp"
+#include "content_hash.hpp"
+#include "trace.hpp"
+
+#include "yaml-cpp/yaml.h"
+
 #include <string>
 #include <fstream>
 #include <vector>
+#include <sstream>
+#include <filesystem>
 
 using namespace std;
 
@@ -45,51 +52,116 @@ std::string rtrim(const std::string &s)
     return (end == std::string::npos) ? "" : s.substr(0, end + 1);
 }
 
-// Write out all helper information.
-void emit_helper_files(YAML::Emitter &out, const metadata_file_finder &finder)
+vector<string> helper_file_paths(const metadata_file_finder &finder)
 {
-    bool header_written = false;
+    vector<string> result;
     for (auto &&hf : _g_helper_files)
     {
-        if (!header_written) {
-            header_written = true;
-            out << YAML::Key << "files" << YAML::Value << YAML::BeginSeq;
+        result.push_back(finder(hf.name));
+    }
+    return result;
+}
+
+string helper_file_text(const vector<string> &lines)
+{
+    auto end = lines.size();
+    while (end > 0 && lines[end - 1].size() == 0) {
+        end--;
+    }
+
+    string text;
+    for (size_t i = 0; i < end; i++) {
+        text += lines[i];
+        text += '\n';
+    }
+    return text;
+}
+
+string helper_file_hash(const vector<string> &lines)
+{
+    fnv1a_hash hash;
+    auto text = helper_file_text(lines);
+    hash.add_bytes(text.data(), text.size());
+    return hash.hex();
+}
+
+// Files can be in the spec as a list of lines or as text, and may already have a hash.
+map<string, string> spec_file_hashes(const string &spec_path)
+{
+    auto spec = YAML::LoadFile(spec_path);
+    map<string, string> result;
+    for (auto &&f : spec["files"])
+    {
+        auto name = f["name"].as<string>();
+        if (f["content_hash"]) {
+            result[name] = f["content_hash"].as<string>();
+        } else if (f["contents"]) {
+            result[name] = helper_file_hash(f["contents"].as<vector<string>>());
+        } else if (f["text"]) {
+            vector<string> lines;
+            istringstream text(f["text"].as<string>());
+            string line;
+            while (getline(text, line)) {
+                lines.push_back(line);
+            }
+            result[name] = helper_file_hash(lines);
         }
+    }
+    return result;
+}
 
-        out << YAML::BeginMap;
+string spec_reference_id(const string &spec_path)
+{
+    auto spec = YAML::LoadFile(spec_path);
+    if (spec["config"] && spec["config"]["content_hash"]) {
+        return spec["config"]["content_hash"].as<string>();
+    }
+    return filesystem::path(spec_path).filename().string();
+}
+
+// Write out all helper information.
+void emit_helper_files(spec_writer &out, const metadata_file_finder &finder, const helper_file_options &options)
+{
+    map<string, string> reference_hashes;
+    string reference_id;
+    if (options.reference_spec.size() > 0) {
+        reference_hashes = spec_file_hashes(options.reference_spec);
+        reference_id = spec_reference_id(options.reference_spec);
+    }
+
+    out.begin_files();
+    for (auto &&hf : _g_helper_files)
+    {
+        scoped_trace_span span("helper_file", "helper files", hf.name);
+        spec_file f;
 
         // Name to write this as
-        auto out_name = hf.name;
+        f.name = hf.name;
         if (hf.layout_name.size() > 0) {
-            out_name = hf.layout_name;
-        }
-
-        // Header info
-        out << YAML::Key << "name" << YAML::Value << out_name;
-        out << YAML::Key << "init_lines" << YAML::Value << YAML::BeginSeq;
-        for (auto &&line : hf.init_lines) {
-            out << line;
+            f.name = hf.layout_name;
         }
-        out << YAML::EndSeq;
+        f.init_lines = hf.init_lines;
 
         // Now file contents
         ifstream file_contents(finder(hf.name));
         string line;
-        out << YAML::Key << "contents" << YAML::Value << YAML::BeginSeq;
         if (!file_contents.is_open()) {
             throw runtime_error("could not find helper file metadata/" + hf.name);
         }
-        out.SetStringFormat(YAML::DoubleQuoted);
         while (getline(file_contents, line)) {
-            out << rtrim(line);
+            f.contents.push_back(rtrim(line));
         }
-        out << YAML::EndSeq;
-
-        out << YAML::EndMap;
 
-    }
+        if (options.as_text || options.reference_spec.size() > 0) {
+            f.as_text = true;
+            f.content_hash = helper_file_hash(f.contents);
+            auto ref = reference_hashes.find(f.name);
+            if (ref != reference_hashes.end() && ref->second == f.content_hash) {
+                f.reference = reference_id;
+            }
+        }
 
-    if (header_written) {
-        out << YAML::EndSeq;
+        out.write_file(f);
     }
+    out.end_files();
 }
\ No newline at end of file
@@ -0,0 +1,488 @@
+#include "json_spec_writer.hpp"
+#include "helper_files.hpp"
+
+#include <fstream>
+#include <regex>
+#include <set>
+#include <cctype>
+
+using namespace std;
+
+namespace {
+    // Plain scalars that the yaml core schema reads as something other than a string.
+    const set<string> _g_yaml_true {"true", "True", "TRUE"};
+    const set<string> _g_yaml_false {"false", "False", "FALSE"};
+    const set<string> _g_yaml_null {"null", "Null", "NULL", "~", ""};
+    const regex _g_json_number("-?(0|[1-9][0-9]*)(\\.[0-9]+)?([eE][+-]?[0-9]+)?");
+
+    void write_json_plain_scalar(ostream &out, const string &s) {
+        if (_g_yaml_true.count(s)) {
+            out << "true";
+        } else if (_g_yaml_false.count(s)) {
+            out << "false";
+        } else if (_g_yaml_null.count(s)) {
+            out << "null";
+        } else if ((s[0] == '-' || isdigit(s[0])) && regex_match(s, _g_json_number)) {
+            out << s;
+        } else {
+            write_json_string(out, s);
+        }
+    }
+
+    // A string the yaml writer emits as it is. yaml-cpp writes it as a plain scalar (so it
+    // reads back as a bool or number if it looks like one), unless it would read back as null.
+    void write_json_emitted_scalar(ostream &out, const string &s) {
+        if (_g_yaml_null.count(s)) {
+            write_json_string(out, s);
+        } else {
+            write_json_plain_scalar(out, s);
+        }
+    }
+
+    // A list of strings as a json array
+    void write_json_strings(ostream &out, const vector<string> &items) {
+        out.put('[');
+        bool first = true;
+        for (auto &&item : items) {
+            if (!first) {
+                out.put(',');
+            }
+            first = false;
+            write_json_string(out, item);
+        }
+        out.put(']');
+    }
+
+    // `"name":` - the start of an item in an object
+    void write_json_key(ostream &out, const char *name) {
+        out.put('"');
+        out << name;
+        out.write("\":", 2);
+    }
+
+    void write_json_arguments(ostream &out, const char *arg_list_name, const vector<spec_argument> &arguments) {
+        if (arguments.size() == 0) {
+            return;
+        }
+        out.put(',');
+        write_json_key(out, arg_list_name);
+        out.put('[');
+        bool first = true;
+        for (auto &&arg : arguments) {
+            if (!first) {
+                out.put(',');
+            }
+            first = false;
+            write_json_key(out << '{', "name");
+            write_json_string(out, arg.name);
+            write_json_key(out << ',', "type");
+            write_json_string(out, arg.type);
+            out.put('}');
+        }
+        out.put(']');
+    }
+
+    // The parameters of a collection
+    void write_json_parameters(ostream &out, const vector<parameter_info_extra> &parameters) {
+        out.put('[');
+        bool first = true;
+        for (auto &&p : parameters) {
+            if (!first) {
+                out.put(',');
+            }
+            first = false;
+            write_json_key(out << '{', "name");
+            write_json_string(out, p.name);
+            write_json_key(out << ',', "type");
+            write_json_string(out, p.p_type);
+            write_json_key(out << ',', "default_value");
+            write_json_emitted_scalar(out, p.p_default);
+            out.put('}');
+        }
+        out.put(']');
+    }
+
+    void write_json_extra_parameters(ostream &out, const vector<parameter_info_extra> &parameters) {
+        out.put('[');
+        bool first = true;
+        for (auto &&p : parameters) {
+            if (!first) {
+                out.put(',');
+            }
+            first = false;
+            write_json_key(out << '{', "name");
+            write_json_string(out, p.name);
+            write_json_key(out << ',', "type");
+            write_json_string(out, p.p_type);
+            write_json_key(out << ',', "default_value");
+            write_json_emitted_scalar(out, p.p_default);
+            write_json_key(out << ',', "actions");
+            out.put('[');
+            bool first_action = true;
+            for (auto &&a : p.variable_actions) {
+                if (!first_action) {
+                    out.put(',');
+                }
+                first_action = false;
+                write_json_key(out << '{', "value");
+                write_json_emitted_scalar(out, a.value);
+                write_json_key(out << ',', "metadata_names");
+                write_json_strings(out, a.metadata_names);
+                write_json_key(out << ',', "bank_rename");
+                write_json_emitted_scalar(out, a.bank_rename);
+                out.put('}');
+            }
+            out.write("]}", 2);
+        }
+        out.put(']');
+    }
+}
+
+// Escape everything json requires, and pass everything else (including utf-8) through.
+void write_json_string(ostream &out, const string &s)
+{
+    out.put('"');
+    const char *start = s.data();
+    const char *end = start + s.size();
+    const char *run = start;
+    for (auto p = start; p != end; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.write(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"': out.write("\\\"", 2); break;
+            case '\\': out.write("\\\\", 2); break;
+            case '\n': out.write("\\n", 2); break;
+            case '\r': out.write("\\r", 2); break;
+            case '\t': out.write("\\t", 2); break;
+            case '\b': out.write("\\b", 2); break;
+            case '\f': out.write("\\f", 2); break;
+            default: {
+                const char *hex = "0123456789abcdef";
+                char buf[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                out.write(buf, 6);
+            }
+        }
+    }
+    out.write(run, end - run);
+    out.put('"');
+}
+
+void write_json(ostream &out, const YAML::Node &node)
+{
+    switch (node.Type()) {
+        case YAML::NodeType::Undefined:
+        case YAML::NodeType::Null:
+            out << "null";
+            break;
+        case YAML::NodeType::Scalar:
+            // Quoted scalars get the "!" tag, plain ones "?".
+            if (node.Tag() == "!") {
+                write_json_string(out, node.Scalar());
+            } else {
+                write_json_plain_scalar(out, node.Scalar());
+            }
+            break;
+        case YAML::NodeType::Sequence: {
+            out.put('[');
+            bool first = true;
+            for (auto &&item : node) {
+                if (!first) {
+                    out.put(',');
+                }
+                first = false;
+                write_json(out, item);
+            }
+            out.put(']');
+            break;
+        }
+        case YAML::NodeType::Map: {
+            out.put('{');
+            bool first = true;
+            for (auto &&item : node) {
+                if (!first) {
+                    out.put(',');
+                }
+                first = false;
+                write_json_string(out, item.first.Scalar());
+                out.put(':');
+                write_json(out, item.second);
+            }
+            out.put('}');
+            break;
+        }
+    }
+}
+
+json_spec_writer::json_spec_writer(ostream &out)
+    : m_out(out), m_first_top_level(true), m_first_item(true)
+{
+    m_out.put('{');
+}
+
+void json_spec_writer::top_level_key(const string &name)
+{
+    if (!m_first_top_level) {
+        m_out.put(',');
+    }
+    m_first_top_level = false;
+    write_json_string(m_out, name);
+    m_out.put(':');
+}
+
+void json_spec_writer::write_collections(const vector<spec_collection> &collections)
+{
+    auto &&out = m_out;
+    top_level_key("collections");
+    out.put('[');
+    bool first = true;
+    for (auto &&c : collections) {
+        if (!first) {
+            out.put(',');
+        }
+        first = false;
+
+        write_json_key(out << '{', "collection_name");
+        write_json_string(out, c.collection_name);
+        write_json_key(out << ',', "cpp_item_type");
+        write_json_string(out, c.cpp_item_type);
+        write_json_key(out << ',', "python_item_type");
+        write_json_string(out, c.python_item_type);
+        write_json_key(out << ',', "cpp_container_type");
+        write_json_string(out, c.cpp_container_type);
+        write_json_key(out << ',', "python_container_type");
+        write_json_string(out, c.python_container_type);
+        write_json_key(out << ',', "include_file");
+        write_json_string(out, c.include_file);
+        write_json_key(out << ',', "link_libraries");
+        write_json_strings(out, c.link_libraries);
+
+        if (c.has_metadata) {
+            auto &&meta_data = c.metadata;
+            if (meta_data.method_callback.size() > 0) {
+                write_json_key(out << ',', "method_callback");
+                write_json_string(out, meta_data.method_callback);
+            }
+            if (meta_data.parameters.size() > 0) {
+                write_json_key(out << ',', "parameters");
+                write_json_parameters(out, meta_data.parameters);
+            }
+            if (meta_data.extra_parameters.size() > 0) {
+                write_json_key(out << ',', "extra_parameters");
+                write_json_extra_parameters(out, meta_data.extra_parameters);
+            }
+        } else {
+            // The default name parameter for collections that have no actions associated
+            // with them.
+            write_json_key(out << ',', "parameters");
+            out << "[{\"name\":\"name\",\"type\":\"str\"}]";
+        }
+
+        out.put('}');
+    }
+    out.put(']');
+}
+
+void json_spec_writer::begin_classes()
+{
+    top_level_key("classes");
+    m_out.put('[');
+    m_first_item = true;
+}
+
+void json_spec_writer::write_class(const spec_class &c)
+{
+    auto &&out = m_out;
+    if (!m_first_item) {
+        out.put(',');
+    }
+    m_first_item = false;
+
+    write_json_key(out << '{', "python_name");
+    write_json_string(out, c.python_name);
+    write_json_key(out << ',', "cpp_name");
+    write_json_string(out, c.cpp_name);
+
+    if (c.library.size() > 0) {
+        write_json_key(out << ',', "library");
+        write_json_string(out, c.library);
+    }
+
+    if (c.is_container) {
+        write_json_key(out << ',', "is_container_of_cpp");
+        write_json_string(out, c.is_container_of_cpp);
+        write_json_key(out << ',', "is_container_of_python");
+        write_json_string(out, c.is_container_of_python);
+    }
+
+    if (c.include_file.size() > 0) {
+        write_json_key(out << ',', "include_file");
+        write_json_string(out, c.include_file);
+    }
+
+    if (c.also_behaves_like.size() > 0) {
+        write_json_key(out << ',', "also_behaves_like");
+        write_json_strings(out, c.also_behaves_like);
+    }
+
+    if (c.inherits_from.size() > 0) {
+        write_json_key(out << ',', "inherits_from");
+        write_json_strings(out, c.inherits_from);
+    }
+
+    if (c.enums.size() > 0) {
+        write_json_key(out << ',', "enums");
+        out.put('[');
+        bool first_enum = true;
+        for (auto &&e : c.enums) {
+            if (!first_enum) {
+                out.put(',');
+            }
+            first_enum = false;
+            write_json_key(out << '{', "name");
+            write_json_string(out, e.name);
+            write_json_key(out << ',', "values");
+            out.put('[');
+            bool first_value = true;
+            for (auto &&v : e.values) {
+                if (!first_value) {
+                    out.put(',');
+                }
+                first_value = false;
+                write_json_key(out << '{', "name");
+                write_json_string(out, v.first);
+                write_json_key(out << ',', "value");
+                out << v.second;
+                out.put('}');
+            }
+            out.write("]}", 2);
+        }
+        out.put(']');
+    }
+
+    if (c.methods.size() > 0) {
+        write_json_key(out << ',', "methods");
+        out.put('[');
+        bool first_method = true;
+        for (auto &&meth : c.methods) {
+            if (!first_method) {
+                out.put(',');
+            }
+            first_method = false;
+            write_json_key(out << '{', "name");
+            write_json_string(out, meth.name);
+            write_json_key(out << ',', "return_type");
+            write_json_string(out, meth.return_type);
+
+            write_json_arguments(out, "arguments", meth.arguments);
+            write_json_arguments(out, "parameter_arguments", meth.parameter_arguments);
+
+            if (meth.param_helper.size() > 0) {
+                write_json_key(out << ',', "param_helper");
+                write_json_string(out, meth.param_helper);
+            }
+            if (meth.param_type_callback.size() > 0) {
+                write_json_key(out << ',', "param_type_callback");
+                write_json_string(out, meth.param_type_callback);
+            }
+            out.put('}');
+        }
+        out.put(']');
+    }
+
+    out.put('}');
+}
+
+void json_spec_writer::end_classes()
+{
+    m_out.put(']');
+}
+
+// Like the yaml, the files key is only written if there is at least one file.
+void json_spec_writer::begin_files()
+{
+    m_first_item = true;
+}
+
+void json_spec_writer::write_file(const spec_file &f)
+{
+    auto &&out = m_out;
+    if (m_first_item) {
+        top_level_key("files");
+        out.put('[');
+    } else {
+        out.put(',');
+    }
+    m_first_item = false;
+
+    write_json_key(out << '{', "name");
+    write_json_string(out, f.name);
+    write_json_key(out << ',', "init_lines");
+    write_json_strings(out, f.init_lines);
+    if (f.reference.size() > 0) {
+        write_json_key(out << ',', "content_hash");
+        write_json_string(out, f.content_hash);
+        write_json_key(out << ',', "reference");
+        write_json_string(out, f.reference);
+    } else if (f.as_text) {
+        write_json_key(out << ',', "content_hash");
+        write_json_string(out, f.content_hash);
+        write_json_key(out << ',', "text");
+        write_json_string(out, helper_file_text(f.contents));
+    } else {
+        write_json_key(out << ',', "contents");
+        write_json_strings(out, f.contents);
+    }
+    out.put('}');
+}
+
+void json_spec_writer::end_files()
+{
+    if (!m_first_item) {
+        m_out.put(']');
+    }
+}
+
+void json_spec_writer::write_config(const spec_config &config)
+{
+    auto &&out = m_out;
+    top_level_key("config");
+    write_json_key(out << '{', "atlas_release");
+    write_json_string(out, config.atlas_release);
+    write_json_key(out << ',', "dataset_types");
+    write_json_strings(out, config.dataset_types);
+    if (config.declared_methods_only) {
+        write_json_key(out << ',', "declared_methods_only");
+        out << "true";
+    }
+    if (config.content_hash.size() > 0) {
+        write_json_key(out << ',', "content_hash");
+        write_json_string(out, config.content_hash);
+    }
+    if (config.inputs_hash.size() > 0) {
+        write_json_key(out << ',', "inputs_hash");
+        write_json_string(out, config.inputs_hash);
+    }
+    out.put('}');
+}
+
+// The extra metadata is a yaml map - its top level items become top level
+// items in the json.
+void json_spec_writer::finish(const string &extra_metadata_path)
+{
+    ifstream metadata_in(extra_metadata_path);
+    if (metadata_in.is_open()) {
+        auto metadata = YAML::Load(metadata_in);
+        if (metadata.IsMap()) {
+            for (auto &&item : metadata) {
+                top_level_key(item.first.Scalar());
+                write_json(m_out, item.second);
+            }
+        }
+    }
+    m_out.put('}');
+    m_out << endl;
+}
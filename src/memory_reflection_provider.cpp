@@ -0,0 +1,312 @@
+#include "memory_reflection_provider.hpp"
+#include "type_helpers.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+using namespace std;
+
+namespace {
+    string as_string(const YAML::Node &node) {
+        return node ? node.as<string>() : string();
+    }
+
+    vector<method_arg> load_arguments(const YAML::Node &args) {
+        vector<method_arg> result;
+        for (auto &&a : args) {
+            method_arg arg;
+            arg.name = as_string(a["name"]);
+            arg.raw_typename = as_string(a["type"]);
+            arg.full_typename = a["full_type"] ? a["full_type"].as<string>() : arg.raw_typename;
+            result.push_back(arg);
+        }
+        return result;
+    }
+
+    reflected_class load_class(const YAML::Node &c) {
+        reflected_class result;
+        result.name = c["name"].as<string>();
+        result.library = as_string(c["library"]);
+        result.declaration_file = as_string(c["declaration_file"]);
+        if (c["bases"]) {
+            result.public_bases = c["bases"].as<vector<string>>();
+        }
+        for (auto &&m : c["methods"]) {
+            method_info mi;
+            mi.name = m["name"].as<string>();
+            mi.return_type = as_string(m["return_type"]);
+            mi.declaring_class = as_string(m["declaring_class"]);
+            mi.arguments = load_arguments(m["arguments"]);
+            result.methods.push_back(mi);
+        }
+        for (auto &&e : c["enums"]) {
+            enum_info ei;
+            ei.name = e["name"].as<string>();
+            for (auto &&v : e["values"]) {
+                ei.values.push_back(make_pair(v["name"].as<string>(), v["value"].as<int>()));
+            }
+            result.enums.push_back(ei);
+        }
+        return result;
+    }
+
+    void write_class(YAML::Emitter &out, const reflected_class &c) {
+        out << YAML::BeginMap;
+        out << YAML::Key << "name" << YAML::Value << c.name;
+        if (c.library.size() > 0) {
+            out << YAML::Key << "library" << YAML::Value << c.library;
+        }
+        if (c.declaration_file.size() > 0) {
+            out << YAML::Key << "declaration_file" << YAML::Value << c.declaration_file;
+        }
+        out << YAML::Key << "bases" << YAML::Value << YAML::Flow << c.public_bases;
+
+        out << YAML::Key << "methods" << YAML::Value << YAML::BeginSeq;
+        for (auto &&m : c.methods) {
+            out << YAML::BeginMap;
+            out << YAML::Key << "name" << YAML::Value << m.name;
+            out << YAML::Key << "return_type" << YAML::Value << m.return_type;
+            if (m.declaring_class.size() > 0) {
+                out << YAML::Key << "declaring_class" << YAML::Value << m.declaring_class;
+            }
+            out << YAML::Key << "arguments" << YAML::Value << YAML::BeginSeq;
+            for (auto &&a : m.arguments) {
+                out << YAML::Flow << YAML::BeginMap;
+                out << YAML::Key << "name" << YAML::Value << a.name;
+                out << YAML::Key << "type" << YAML::Value << a.raw_typename;
+                out << YAML::Key << "full_type" << YAML::Value << a.full_typename;
+                out << YAML::EndMap;
+            }
+            out << YAML::EndSeq;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+
+        out << YAML::Key << "enums" << YAML::Value << YAML::BeginSeq;
+        for (auto &&e : c.enums) {
+            out << YAML::BeginMap;
+            out << YAML::Key << "name" << YAML::Value << e.name;
+            out << YAML::Key << "values" << YAML::Value << YAML::BeginSeq;
+            for (auto &&v : e.values) {
+                out << YAML::Flow << YAML::BeginMap;
+                out << YAML::Key << "name" << YAML::Value << v.first;
+                out << YAML::Key << "value" << YAML::Value << v.second;
+                out << YAML::EndMap;
+            }
+            out << YAML::EndSeq;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+        out << YAML::EndMap;
+    }
+}
+
+memory_reflection_provider::memory_reflection_provider(const string &path)
+{
+    auto doc = YAML::LoadFile(path);
+    for (auto &&c : doc["classes"]) {
+        add_class(load_class(c));
+    }
+    for (auto &&a : doc["aliases"]) {
+        add_alias(a.first.as<string>(), a.second.as<string>());
+    }
+    for (auto &&t : doc["typedefs"]) {
+        add_typedef(t.first.as<string>(), t.second.as<string>());
+    }
+    for (auto &&f : doc["include_files"]) {
+        add_include_file(f.as<string>());
+    }
+}
+
+void memory_reflection_provider::add_class(const reflected_class &c)
+{
+    m_classes[c.name] = c;
+}
+
+void memory_reflection_provider::add_alias(const string &name, const string &class_name)
+{
+    m_aliases[name] = class_name;
+}
+
+void memory_reflection_provider::add_typedef(const string &name, const string &type)
+{
+    m_typedefs[name] = type;
+}
+
+void memory_reflection_provider::add_include_file(const string &include_path)
+{
+    m_include_files.insert(include_path);
+}
+
+void memory_reflection_provider::write(ostream &out) const
+{
+    YAML::Emitter yaml(out);
+    yaml << YAML::BeginMap;
+
+    yaml << YAML::Key << "classes" << YAML::Value << YAML::BeginSeq;
+    for (auto &&c : m_classes) {
+        write_class(yaml, c.second);
+    }
+    yaml << YAML::EndSeq;
+
+    yaml << YAML::Key << "aliases" << YAML::Value << m_aliases;
+    yaml << YAML::Key << "typedefs" << YAML::Value << m_typedefs;
+    yaml << YAML::Key << "include_files" << YAML::Value
+         << vector<string>(m_include_files.begin(), m_include_files.end());
+
+    yaml << YAML::EndMap;
+    out << endl;
+}
+
+string memory_reflection_provider::class_name(const string &name)
+{
+    set<string> visited;
+    return class_name(name, visited);
+}
+
+string memory_reflection_provider::class_name(const string &name, set<string> &visited)
+{
+    // Like ROOT, skip the internal classes. A typedef loop resolves to nothing.
+    if (name.size() == 0 || name.find("__") != string::npos || !visited.insert(name).second) {
+        return "";
+    }
+
+    if (m_classes.find(name) != m_classes.end()) {
+        return name;
+    }
+    auto alias = m_aliases.find(name);
+    if (alias != m_aliases.end()) {
+        return alias->second;
+    }
+    auto td = m_typedefs.find(name);
+    if (td != m_typedefs.end()) {
+        return class_name(td->second, visited);
+    }
+
+    // Perhaps just spelled differently (e.g. "> >" rather than ">>")
+    auto normalized = parse_typename(name).cpp_name;
+    if (normalized != name) {
+        return class_name(normalized, visited);
+    }
+    return "";
+}
+
+reflected_class memory_reflection_provider::get_class(const string &name)
+{
+    auto c = m_classes.find(name);
+    return c == m_classes.end() ? reflected_class() : c->second;
+}
+
+string memory_reflection_provider::class_library(const string &name)
+{
+    auto c_name = class_name(name);
+    if (c_name.size() == 0) {
+        return "";
+    }
+    return m_classes.at(c_name).library;
+}
+
+vector<string> memory_reflection_provider::public_bases(const string &name)
+{
+    auto c_name = class_name(name);
+    if (c_name.size() == 0) {
+        return vector<string>();
+    }
+    return m_classes.at(c_name).public_bases;
+}
+
+vector<string> memory_reflection_provider::loaded_classes()
+{
+    vector<string> result;
+    for (auto &&c : m_classes) {
+        result.push_back(c.first);
+    }
+    return result;
+}
+
+bool memory_reflection_provider::include_file_exists(const string &include_path)
+{
+    return m_include_files.find(include_path) != m_include_files.end();
+}
+
+recording_reflection_provider::recording_reflection_provider(shared_ptr<reflection_provider> inner)
+    : m_inner(inner)
+{
+}
+
+void recording_reflection_provider::record_class(const string &name)
+{
+    if (m_recorded_classes.insert(name).second) {
+        m_recorded.add_class(m_inner->get_class(name));
+    }
+}
+
+int recording_reflection_provider::load_library(const string &name)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    return m_inner->load_library(name);
+}
+
+string recording_reflection_provider::class_name(const string &name)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    auto result = m_inner->class_name(name);
+    if (result.size() > 0) {
+        record_class(result);
+        if (result != name) {
+            m_recorded.add_alias(name, result);
+        }
+    }
+    return result;
+}
+
+reflected_class recording_reflection_provider::get_class(const string &name)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    auto result = m_inner->get_class(name);
+    if (result.name.size() > 0 && m_recorded_classes.insert(name).second) {
+        m_recorded.add_class(result);
+    }
+    return result;
+}
+
+string recording_reflection_provider::class_library(const string &name)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    // Recording the class records its library
+    auto c_name = class_name(name);
+    return c_name.size() == 0 ? "" : m_inner->class_library(c_name);
+}
+
+vector<string> recording_reflection_provider::public_bases(const string &name)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    // Recording the class records its bases
+    auto c_name = class_name(name);
+    return c_name.size() == 0 ? vector<string>() : m_inner->public_bases(c_name);
+}
+
+map<string, string> recording_reflection_provider::typedefs()
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    auto result = m_inner->typedefs();
+    for (auto &&t : result) {
+        m_recorded.add_typedef(t.first, t.second);
+    }
+    return result;
+}
+
+vector<string> recording_reflection_provider::loaded_classes()
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    return m_inner->loaded_classes();
+}
+
+bool recording_reflection_provider::include_file_exists(const string &include_path)
+{
+    lock_guard<recursive_mutex> guard(m_lock);
+    auto result = m_inner->include_file_exists(include_path);
+    if (result) {
+        m_recorded.add_include_file(include_path);
+    }
+    return result;
+}
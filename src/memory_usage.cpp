@@ -0,0 +1,40 @@
+#include "memory_usage.hpp"
+
+#include <fstream>
+#include <algorithm>
+
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+memory_sample sample_memory()
+{
+    memory_sample result;
+
+#if defined(__linux__)
+    // Second field is the resident size in pages
+    ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0, resident_pages = 0;
+    if (statm >> size_pages >> resident_pages) {
+        result.rss_bytes = resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+
+    // ru_maxrss is in kB on linux. It is updated a little behind the resident size, so
+    // never let it be less than what we just read.
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        result.peak_rss_bytes = max(static_cast<uint64_t>(usage.ru_maxrss) * 1024, result.rss_bytes);
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    auto info = mallinfo2();
+    result.heap_in_use_bytes = info.uordblks + info.hblkhd;
+#endif
+
+    return result;
+}
@@ -0,0 +1,140 @@
+#include "phase_timer.hpp"
+#include "json_spec_writer.hpp"
+
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    double seconds_since(chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    double cpu_seconds_since(clock_t start) {
+        return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    }
+
+    void write_timing_json(ostream &out, const phase_timing &t) {
+        out << "{\"name\": ";
+        write_json_string(out, t.name);
+        out << ", \"wall_seconds\": " << t.wall_seconds
+            << ", \"cpu_seconds\": " << t.cpu_seconds;
+        out << ", \"rss_bytes\": " << t.memory.rss_bytes
+            << ", \"rss_change_bytes\": " << t.rss_change_bytes
+            << ", \"peak_rss_bytes\": " << t.memory.peak_rss_bytes
+            << ", \"heap_in_use_bytes\": " << t.memory.heap_in_use_bytes;
+        if (allocations_tracked()) {
+            out << ", \"allocations\": " << t.allocations
+                << ", \"bytes_allocated\": " << t.bytes_allocated
+                << ", \"peak_live_bytes\": " << t.peak_live_bytes;
+        }
+        out << "}";
+    }
+
+    void set_memory(phase_timing &t, const alloc_totals &start_allocs, const memory_sample &start_memory) {
+        auto allocs = read_alloc_totals() - start_allocs;
+        t.allocations = allocs.allocations;
+        t.bytes_allocated = allocs.bytes_allocated;
+
+        t.memory = sample_memory();
+        t.rss_change_bytes = static_cast<int64_t>(t.memory.rss_bytes) - static_cast<int64_t>(start_memory.rss_bytes);
+    }
+
+    double megabytes(double bytes) {
+        return bytes / (1024.0 * 1024.0);
+    }
+}
+
+phase_timer::phase_timer()
+    : m_start_wall(chrono::steady_clock::now()), m_start_cpu(clock()), m_start_allocs(read_alloc_totals()),
+      m_start_memory(sample_memory())
+{
+}
+
+phase_timing phase_timer::total() const
+{
+    phase_timing result;
+    result.name = "total";
+    result.wall_seconds = seconds_since(m_start_wall);
+    result.cpu_seconds = cpu_seconds_since(m_start_cpu);
+    set_memory(result, m_start_allocs, m_start_memory);
+    result.peak_live_bytes = tracked_peak_live_bytes();
+    return result;
+}
+
+scoped_phase::scoped_phase(phase_timer &timer, const string &name)
+    : m_timer(timer), m_name(name), m_start_wall(chrono::steady_clock::now()), m_start_cpu(clock()),
+      m_start_allocs(read_alloc_totals()), m_start_memory(sample_memory()),
+      m_outer_peak_live_bytes(reset_recent_peak_live_bytes()), m_span(m_name.c_str(), "phase")
+{
+}
+
+scoped_phase::~scoped_phase()
+{
+    phase_timing t;
+    t.name = m_name;
+    t.wall_seconds = seconds_since(m_start_wall);
+    t.cpu_seconds = cpu_seconds_since(m_start_cpu);
+    set_memory(t, m_start_allocs, m_start_memory);
+    t.peak_live_bytes = recent_peak_live_bytes();
+    raise_recent_peak_live_bytes(m_outer_peak_live_bytes);
+    m_timer.m_phases.push_back(t);
+}
+
+void write_phase_table(ostream &out, const phase_timer &timer)
+{
+    auto total = timer.total();
+    size_t width = total.name.size();
+    for (auto &&p : timer.phases()) {
+        width = max(width, p.name.size());
+    }
+    bool show_allocations = allocations_tracked();
+
+    auto line = [&out, width, &total, show_allocations](const phase_timing &t) {
+        double fraction = total.wall_seconds > 0 ? t.wall_seconds / total.wall_seconds : 0.0;
+        out << "  " << left << setw(width) << t.name << right
+            << fixed << setprecision(3)
+            << setw(12) << t.wall_seconds
+            << setw(12) << t.cpu_seconds
+            << setw(9) << setprecision(1) << (100.0 * fraction) << "%"
+            << setw(10) << megabytes(t.memory.rss_bytes)
+            << setw(10) << showpos << megabytes(t.rss_change_bytes) << noshowpos
+            << setw(10) << megabytes(t.memory.peak_rss_bytes)
+            << setw(10) << megabytes(t.memory.heap_in_use_bytes);
+        if (show_allocations) {
+            out << setw(14) << t.allocations
+                << setw(12) << megabytes(t.bytes_allocated)
+                << setw(14) << megabytes(t.peak_live_bytes);
+        }
+        out << defaultfloat << endl;
+    };
+
+    out << "  " << left << setw(width) << "phase" << right
+        << setw(12) << "wall (s)" << setw(12) << "cpu (s)" << setw(10) << "wall"
+        << setw(10) << "RSS MB" << setw(10) << "+RSS MB" << setw(10) << "peak MB" << setw(10) << "heap MB";
+    if (show_allocations) {
+        out << setw(14) << "allocations" << setw(12) << "alloc MB" << setw(14) << "max live MB";
+    }
+    out << endl;
+    for (auto &&p : timer.phases()) {
+        line(p);
+    }
+    line(total);
+}
+
+void write_phase_json(ostream &out, const phase_timer &timer)
+{
+    out << "{\"phases\": [";
+    bool first = true;
+    for (auto &&p : timer.phases()) {
+        if (!first) {
+            out << ", ";
+        }
+        first = false;
+        write_timing_json(out, p);
+    }
+    out << "], \"total\": ";
+    write_timing_json(out, timer.total());
+    out << "}" << endl;
+}
@@ -0,0 +1,28 @@
+#include "reflection_provider.hpp"
+#include "root_reflection_provider.hpp"
+
+using namespace std;
+
+namespace {
+    shared_ptr<reflection_provider> _g_reflection;
+}
+
+reflection_provider &reflection()
+{
+    return *current_reflection_provider();
+}
+
+shared_ptr<reflection_provider> current_reflection_provider()
+{
+    if (!_g_reflection) {
+        _g_reflection = make_shared<root_reflection_provider>();
+    }
+    return _g_reflection;
+}
+
+shared_ptr<reflection_provider> set_reflection_provider(shared_ptr<reflection_provider> provider)
+{
+    auto old = _g_reflection;
+    _g_reflection = provider;
+    return old;
+}
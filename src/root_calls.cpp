@@ -0,0 +1,167 @@
+#include "root_calls.hpp"
+
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TClass.h"
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    const size_t n_root_calls = static_cast<size_t>(root_call::n_calls);
+
+    array<atomic<uint64_t>, n_root_calls> _g_calls{};
+    array<atomic<uint64_t>, n_root_calls> _g_nanoseconds{};
+
+    const char *_g_call_names[] = {
+        "TClass::GetClass",
+        "TClass::GetListOfAllPublicMethods",
+        "TClass::GetListOfBases",
+        "TClass::GetListOfEnums",
+        "TROOT::GetListOfTypes",
+        "TROOT::GetListOfClasses",
+        "TSystem::Load",
+        "TSystem::ExpandPathName",
+        "TSystem::AccessPathName",
+    };
+    static_assert(sizeof(_g_call_names) / sizeof(_g_call_names[0]) == n_root_calls,
+        "Every ROOT call needs a name");
+
+    // Counts one call, and the time until it goes out of scope
+    class timed_root_call {
+    public:
+        timed_root_call(root_call c)
+            : m_index(static_cast<size_t>(c)), m_start(chrono::steady_clock::now())
+        {}
+        ~timed_root_call() {
+            auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_start).count();
+            _g_calls[m_index].fetch_add(1, memory_order_relaxed);
+            _g_nanoseconds[m_index].fetch_add(static_cast<uint64_t>(ns), memory_order_relaxed);
+        }
+    private:
+        size_t m_index;
+        chrono::steady_clock::time_point m_start;
+    };
+}
+
+root_call_totals root_call_totals::operator-(const root_call_totals &earlier) const
+{
+    root_call_totals result;
+    for (size_t i = 0; i < values.size(); i++) {
+        result.values[i].calls = values[i].calls - earlier.values[i].calls;
+        result.values[i].seconds = values[i].seconds - earlier.values[i].seconds;
+    }
+    return result;
+}
+
+root_call_totals read_root_call_totals()
+{
+    root_call_totals result;
+    for (size_t i = 0; i < n_root_calls; i++) {
+        result.values[i].calls = _g_calls[i].load(memory_order_relaxed);
+        result.values[i].seconds = _g_nanoseconds[i].load(memory_order_relaxed) * 1e-9;
+    }
+    return result;
+}
+
+string root_call_name(root_call c)
+{
+    return _g_call_names[static_cast<size_t>(c)];
+}
+
+void write_root_call_table(ostream &out, const root_call_totals &totals)
+{
+    vector<size_t> order;
+    for (size_t i = 0; i < n_root_calls; i++) {
+        if (totals.values[i].calls > 0) {
+            order.push_back(i);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&totals](size_t a, size_t b) {
+        return totals.values[a].seconds > totals.values[b].seconds;
+    });
+
+    auto old_flags = out.flags();
+    auto old_precision = out.precision();
+    out << "  " << left << setw(34) << "ROOT call" << right
+        << setw(12) << "calls" << setw(12) << "total (s)" << setw(12) << "mean (us)" << endl;
+    for (auto i : order) {
+        auto &&t = totals.values[i];
+        out << "  " << left << setw(34) << _g_call_names[i] << right
+            << setw(12) << t.calls
+            << fixed << setprecision(3) << setw(12) << t.seconds
+            << setprecision(1) << setw(12) << (t.seconds * 1e6 / t.calls) << endl;
+    }
+    out.flags(old_flags);
+    out.precision(old_precision);
+}
+
+void write_root_call_json(ostream &out, const root_call_totals &totals)
+{
+    out << "{";
+    for (size_t i = 0; i < n_root_calls; i++) {
+        out << (i == 0 ? "" : ", ") << "\"" << _g_call_names[i] << "\": {\"calls\": " << totals.values[i].calls
+            << ", \"seconds\": " << totals.values[i].seconds << "}";
+    }
+    out << "}";
+}
+
+TClass *root_get_class(const string &name)
+{
+    timed_root_call t(root_call::get_class);
+    return TClass::GetClass(name.c_str());
+}
+
+const TCollection *root_list_of_all_public_methods(TClass *c)
+{
+    timed_root_call t(root_call::get_list_of_all_public_methods);
+    return c->GetListOfAllPublicMethods();
+}
+
+const TCollection *root_list_of_bases(TClass *c)
+{
+    timed_root_call t(root_call::get_list_of_bases);
+    return c->GetListOfBases();
+}
+
+const TCollection *root_list_of_enums(TClass *c)
+{
+    timed_root_call t(root_call::get_list_of_enums);
+    return c->GetListOfEnums();
+}
+
+const TCollection *root_list_of_types()
+{
+    timed_root_call t(root_call::get_list_of_types);
+    return gROOT->GetListOfTypes(true);
+}
+
+const TCollection *root_list_of_classes()
+{
+    timed_root_call t(root_call::get_list_of_classes);
+    return gROOT->GetListOfClasses();
+}
+
+int root_load_library(const string &name)
+{
+    timed_root_call t(root_call::load);
+    return gSystem->Load(name.c_str());
+}
+
+string root_expand_path_name(const string &path)
+{
+    timed_root_call t(root_call::expand_path_name);
+    return gSystem->ExpandPathName(path.c_str());
+}
+
+bool root_file_exists(const string &path)
+{
+    timed_root_call t(root_call::access_path_name);
+    // AccessPathName returns false if the file is there
+    return !gSystem->AccessPathName(path.c_str(), kFileExists);
+}
@@ -0,0 +1,185 @@
+#include "root_reflection_provider.hpp"
+#include "root_calls.hpp"
+#include "run_stats.hpp"
+
+#include "TClass.h"
+#include "TBaseClass.h"
+#include "TMethod.h"
+#include "TMethodArg.h"
+#include "TEnum.h"
+#include "TEnumConstant.h"
+#include "TDataType.h"
+
+using namespace std;
+
+namespace {
+    method_arg translate_argument(const TMethodArg *arg) {
+        method_arg result;
+        result.name = arg->GetName();
+        result.raw_typename = arg->GetTypeName();
+        result.full_typename = arg->GetFullTypeName();
+        return result;
+    }
+
+    method_info translate_method(TMethod *method) {
+        method_info m;
+        m.name = method->GetName();
+        if (method->GetClass() != nullptr) {
+            m.declaring_class = method->GetClass()->GetName();
+        }
+        m.return_type = method->GetReturnTypeName();
+
+        auto l = method->GetListOfMethodArgs();
+        for (int i_arg = 0; i_arg < l->GetSize(); i_arg++) {
+            m.arguments.push_back(translate_argument(static_cast<TMethodArg*> (l->At(i_arg))));
+        }
+        return m;
+    }
+
+    vector<string> public_bases(TClass *c_info) {
+        auto inherited_list = root_list_of_bases(c_info);
+        TIter next(inherited_list);
+        vector<string> result;
+        while (auto bobj = static_cast<TBaseClass *>(next()))
+        {
+            // Do not grab private or protected inheritance. Only the public
+            // interface for us.
+            if (
+                ((bobj->Property() & kIsPrivate) == 0) && ((bobj->Property() & kIsProtected) == 0))
+            {
+                auto cl = bobj->GetClassPointer();
+                result.push_back(cl->GetName());
+            }
+        }
+        return result;
+    }
+}
+
+int root_reflection_provider::load_library(const string &name)
+{
+    return root_load_library(name);
+}
+
+string root_reflection_provider::class_name(const string &name)
+{
+    auto c_info = get_tclass(name);
+    return c_info == nullptr ? "" : c_info->GetName();
+}
+
+reflected_class root_reflection_provider::get_class(const string &name)
+{
+    reflected_class result;
+    auto c_info = get_tclass(name);
+    if (c_info == nullptr) {
+        return result;
+    }
+
+    result.name = c_info->GetName();
+    if (c_info->GetSharedLibs() != nullptr) {
+        result.library = c_info->GetSharedLibs();
+    }
+    if (c_info->GetDeclFileName() != nullptr) {
+        result.declaration_file = c_info->GetDeclFileName();
+    }
+    result.public_bases = ::public_bases(c_info);
+
+    auto all_methods = root_list_of_all_public_methods(c_info);
+    TIter next(all_methods);
+    while (auto method = static_cast<TMethod *>(next.Next()))
+    {
+        result.methods.push_back(translate_method(method));
+    }
+
+    auto all_enums = root_list_of_enums(c_info);
+    TIter next_enum(all_enums);
+    while (auto enum_obj = static_cast<TEnum *>(next_enum()))
+    {
+        enum_info e_info;
+        e_info.name = enum_obj->GetName();
+
+        auto all_values = enum_obj->GetConstants();
+        TIter next_value(all_values);
+        while (auto value = static_cast<TEnumConstant *>(next_value()))
+        {
+            e_info.values.push_back(make_pair(value->GetName(), value->GetValue()));
+        }
+        result.enums.push_back(move(e_info));
+    }
+
+    return result;
+}
+
+string root_reflection_provider::class_library(const string &name)
+{
+    auto c_info = get_tclass(name);
+    if (c_info == nullptr || c_info->GetSharedLibs() == nullptr) {
+        return "";
+    }
+    return c_info->GetSharedLibs();
+}
+
+vector<string> root_reflection_provider::public_bases(const string &name)
+{
+    auto c_info = get_tclass(name);
+    if (c_info == nullptr) {
+        return vector<string>();
+    }
+    return ::public_bases(c_info);
+}
+
+map<string, string> root_reflection_provider::typedefs()
+{
+    map<string, string> result;
+	auto all_types = root_list_of_types();
+	TIter i_typedef (all_types);
+	int junk = all_types->GetEntries();
+	TDataType *typedef_spec;
+	while ((typedef_spec = static_cast<TDataType*>(i_typedef.Next())) != 0)
+	{
+		string typedef_name = typedef_spec->GetName();
+		string base_name = typedef_spec->GetFullTypeName();
+
+        if (typedef_name != base_name) {
+            result[typedef_name] = base_name;
+        }
+    }
+    return result;
+}
+
+vector<string> root_reflection_provider::loaded_classes()
+{
+    vector<string> result;
+    TIter next(root_list_of_classes());
+    while (auto c_info = static_cast<TClass *>(next()))
+    {
+        result.push_back(c_info->GetName());
+    }
+    return result;
+}
+
+bool root_reflection_provider::include_file_exists(const string &include_path)
+{
+    string full = "$ROOTCOREDIR/include/" + include_path;
+    return root_file_exists(root_expand_path_name(full));
+}
+
+// Get a TClass pointer, but protect against fetching
+// internal classes.
+TClass *get_tclass(const string &name)
+{
+    // Any type that looks like it has something internal,
+    // like __gnu_cxx::xxxx. ROOT has some issue with these,
+    // printing out error messages to cout (rather than cerr),
+    // which pollutes out output, of course. We don't need them,
+    // so avoid them.
+    if (name.find("__") != string::npos) {
+        return nullptr;
+    }
+
+    add_count(run_counter::tclass_lookups);
+    auto c_info = root_get_class(name);
+    if (c_info == nullptr) {
+        add_count(run_counter::tclass_lookup_misses);
+    }
+    return c_info;
+}
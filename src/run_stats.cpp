@@ -0,0 +1,110 @@
+#include "run_stats.hpp"
+
+#include <iomanip>
+
+using namespace std;
+
+namespace run_stats_detail {
+    array<atomic<uint64_t>, static_cast<size_t>(run_counter::n_counters)> counters{};
+}
+
+namespace {
+    const char *_g_counter_names[] = {
+        "tclass_lookups",
+        "tclass_lookup_misses",
+        "parse_typename_calls",
+        "typedef_resolutions",
+        "include_file_checks",
+        "classes_translated",
+        "methods_translated",
+        "enums_translated",
+        "discovery_queue_pushes",
+        "discovery_duplicates",
+        "prune_passes",
+        "bytes_emitted",
+    };
+    static_assert(sizeof(_g_counter_names) / sizeof(_g_counter_names[0]) == static_cast<size_t>(run_counter::n_counters),
+        "Every counter needs a name");
+}
+
+run_counters run_counters::operator-(const run_counters &earlier) const
+{
+    run_counters result;
+    for (size_t i = 0; i < values.size(); i++) {
+        result.values[i] = values[i] - earlier.values[i];
+    }
+    return result;
+}
+
+run_counters read_run_counters()
+{
+    run_counters result;
+    for (size_t i = 0; i < result.values.size(); i++) {
+        result.values[i] = run_stats_detail::counters[i].load(memory_order_relaxed);
+    }
+    return result;
+}
+
+string run_counter_name(run_counter c)
+{
+    return _g_counter_names[static_cast<size_t>(c)];
+}
+
+void write_run_counters(ostream &out, const run_counters &counters)
+{
+    for (size_t i = 0; i < counters.values.size(); i++) {
+        out << "  " << left << setw(24) << _g_counter_names[i] << right << setw(14) << counters.values[i] << endl;
+    }
+}
+
+void write_run_counters_json(ostream &out, const run_counters &counters)
+{
+    out << "{";
+    for (size_t i = 0; i < counters.values.size(); i++) {
+        out << (i == 0 ? "" : ", ") << "\"" << _g_counter_names[i] << "\": " << counters.values[i];
+    }
+    out << "}";
+}
+
+counting_streambuf::counting_streambuf(ostream &out)
+    : m_out(out), m_buffer(64 * 1024)
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+counting_streambuf::~counting_streambuf()
+{
+    flush_buffer();
+}
+
+bool counting_streambuf::flush_buffer()
+{
+    auto n = pptr() - pbase();
+    if (n > 0) {
+        m_out.write(pbase(), n);
+        add_count(run_counter::bytes_emitted, n);
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+    return static_cast<bool>(m_out);
+}
+
+counting_streambuf::int_type counting_streambuf::overflow(int_type c)
+{
+    if (!flush_buffer()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int counting_streambuf::sync()
+{
+    if (!flush_buffer()) {
+        return -1;
+    }
+    m_out.flush();
+    return m_out ? 0 : -1;
+}
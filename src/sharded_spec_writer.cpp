@@ -0,0 +1,277 @@
+#include "sharded_spec_writer.hpp"
+#include "json_spec_writer.hpp"
+#include "type_helpers.hpp"
+#include "run_stats.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <filesystem>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+    // The outer most namespace of a type. Templates in the global namespace
+    // (like vector<xAOD::Jet_v1>) go with their first non-fundamental argument.
+    string outer_namespace(const typename_info &t) {
+        if (t.namespace_list.size() > 0) {
+            auto outer = &t.namespace_list[0];
+            while (outer->namespace_list.size() > 0) {
+                outer = &outer->namespace_list[0];
+            }
+            if (outer->template_arguments.size() > 0) {
+                return outer_namespace(*outer);
+            }
+            return outer->type_name;
+        }
+        for (auto &&t_arg : t.template_arguments) {
+            if (t_arg.namespace_list.size() > 0 || t_arg.template_arguments.size() > 0) {
+                return outer_namespace(t_arg);
+            }
+        }
+        return "global";
+    }
+
+    // Shard names end up as file names.
+    string safe_file_name(const string &name) {
+        string result(name);
+        for (auto &&c : result) {
+            if (!isalnum(c) && c != '_' && c != '-' && c != '.') {
+                c = '_';
+            }
+        }
+        return result;
+    }
+
+    // Add the classes a (C++) type name refers to
+    void add_referenced_types(const string &t_name, set<string> &types) {
+        if (t_name.size() == 0) {
+            return;
+        }
+        auto t = parse_typename(t_name);
+        types.insert(unqualified_typename(t));
+        auto args = type_referenced_types(t);
+        types.insert(args.begin(), args.end());
+    }
+
+    // Add the classes a normalized (python) type name refers to. The only templates
+    // left after normalization are Iterable[...] and cpp_type[...], so look inside those.
+    void add_referenced_python_types(const string &t_name, set<string> &types) {
+        if (t_name.size() == 0) {
+            return;
+        }
+        types.insert(t_name);
+        auto open = t_name.find('[');
+        if (open != string::npos && t_name.back() == ']') {
+            add_referenced_python_types(t_name.substr(open + 1, t_name.size() - open - 2), types);
+        }
+    }
+}
+
+sharded_spec_writer::sharded_spec_writer(const string &directory, spec_format format, spec_shard_by shard_by,
+    spec_compression compression, int compression_threads)
+    : m_directory(directory), m_format(format), m_shard_by(shard_by),
+      m_compression(compression), m_compression_limit(make_shared<compression_thread_limit>(compression_threads))
+{
+    filesystem::create_directories(m_directory);
+    open_file(m_core_file, shard_path("core"));
+    m_core = make_spec_writer(m_format, m_core_file.stream());
+}
+
+string sharded_spec_writer::shard_path(const string &name) const
+{
+    return (filesystem::path(m_directory)
+        / (safe_file_name(name) + "." + spec_file_extension(m_format) + compression_file_extension(m_compression))).string();
+}
+
+void sharded_spec_writer::open_file(output_file &f, const string &path)
+{
+    f.file = make_unique<ofstream>(path, ios::binary);
+    if (!f.file->is_open()) {
+        throw runtime_error("Unable to open " + path + " for writing");
+    }
+    if (m_compression != spec_compression::none) {
+        f.compressed = make_unique<compressing_ostream>(*f.file, m_compression, m_compression_limit);
+    }
+}
+
+void sharded_spec_writer::output_file::close()
+{
+    if (compressed) {
+        compressed->finish();
+        add_count(run_counter::bytes_emitted, compressed->compressor().bytes_in());
+    } else {
+        auto size = file->tellp();
+        if (size > 0) {
+            add_count(run_counter::bytes_emitted, static_cast<uint64_t>(size));
+        }
+    }
+    file->close();
+}
+
+string sharded_spec_writer::shard_name(const spec_class &c) const
+{
+    if (m_shard_by == spec_shard_by::library && c.library.size() > 0) {
+        return c.library;
+    }
+    return outer_namespace(parse_typename(c.cpp_name));
+}
+
+sharded_spec_writer::shard &sharded_spec_writer::get_shard(const string &name)
+{
+    auto itr = m_shards.find(name);
+    if (itr != m_shards.end()) {
+        return itr->second;
+    }
+
+    if (name == "core" || name == "manifest") {
+        throw runtime_error("Shard name " + name + " is reserved");
+    }
+
+    auto &&s = m_shards[name];
+    open_file(s.out, shard_path(name));
+    s.writer = make_spec_writer(m_format, s.out.stream());
+    s.writer->begin_classes();
+    return s;
+}
+
+void sharded_spec_writer::write_collections(const vector<spec_collection> &collections)
+{
+    m_core->write_collections(collections);
+}
+
+// The core gets an empty list of classes, so it has the same layout as a full spec.
+void sharded_spec_writer::begin_classes()
+{
+    m_core->begin_classes();
+}
+
+void sharded_spec_writer::write_class(const spec_class &c)
+{
+    auto name = shard_name(c);
+    auto &&s = get_shard(name);
+    s.writer->write_class(c);
+
+    s.classes.push_back(c.cpp_name);
+    m_shard_of_cpp_class[c.cpp_name] = name;
+    m_shard_of_python_class[c.python_name] = name;
+
+    add_referenced_types(c.is_container_of_cpp, s.referenced_cpp_types);
+    s.referenced_cpp_types.insert(c.inherits_from.begin(), c.inherits_from.end());
+    for (auto &&meth : c.methods) {
+        add_referenced_types(meth.return_type, s.referenced_cpp_types);
+        for (auto &&arg : meth.arguments) {
+            add_referenced_python_types(arg.type, s.referenced_python_types);
+        }
+        for (auto &&arg : meth.parameter_arguments) {
+            add_referenced_python_types(arg.type, s.referenced_python_types);
+        }
+    }
+    s.referenced_python_types.insert(c.also_behaves_like.begin(), c.also_behaves_like.end());
+}
+
+void sharded_spec_writer::end_classes()
+{
+    m_core->end_classes();
+    for (auto &&s : m_shards) {
+        s.second.writer->end_classes();
+    }
+}
+
+void sharded_spec_writer::begin_files()
+{
+    m_core->begin_files();
+}
+
+void sharded_spec_writer::write_file(const spec_file &f)
+{
+    m_core->write_file(f);
+}
+
+void sharded_spec_writer::end_files()
+{
+    m_core->end_files();
+}
+
+// Every shard gets the config so it can be read on its own.
+void sharded_spec_writer::write_config(const spec_config &config)
+{
+    m_core->write_config(config);
+    for (auto &&s : m_shards) {
+        s.second.writer->write_config(config);
+    }
+}
+
+void sharded_spec_writer::finish(const string &extra_metadata_path)
+{
+    m_core->finish(extra_metadata_path);
+    m_core_file.close();
+    for (auto &&s : m_shards) {
+        s.second.writer->finish("");
+        s.second.out.close();
+    }
+
+    if (m_compression != spec_compression::none) {
+        m_compression_stats.add(m_core_file.compressed->compressor());
+        for (auto &&s : m_shards) {
+            m_compression_stats.add(s.second.out.compressed->compressor());
+        }
+    }
+    write_manifest();
+}
+
+void sharded_spec_writer::write_manifest()
+{
+    YAML::Node manifest;
+    manifest["core"] = filesystem::path(shard_path("core")).filename().string();
+
+    YAML::Node shards(YAML::NodeType::Sequence);
+    for (auto &&s : m_shards) {
+        // Which other shards do the types this one references live in?
+        set<string> depends_on;
+        for (auto &&t : s.second.referenced_cpp_types) {
+            auto itr = m_shard_of_cpp_class.find(t);
+            if (itr != m_shard_of_cpp_class.end() && itr->second != s.first) {
+                depends_on.insert(itr->second);
+            }
+        }
+        for (auto &&t : s.second.referenced_python_types) {
+            auto itr = m_shard_of_python_class.find(t);
+            if (itr != m_shard_of_python_class.end() && itr->second != s.first) {
+                depends_on.insert(itr->second);
+            }
+        }
+
+        YAML::Node s_node;
+        s_node["name"] = s.first;
+        s_node["file"] = filesystem::path(shard_path(s.first)).filename().string();
+        s_node["classes"] = s.second.classes.size();
+        s_node["depends_on"] = YAML::Node(YAML::NodeType::Sequence);
+        for (auto &&d : depends_on) {
+            s_node["depends_on"].push_back(d);
+        }
+        shards.push_back(s_node);
+    }
+    manifest["shards"] = shards;
+
+    // The names are already unique - force_insert skips yaml-cpp's linear key lookup.
+    YAML::Node classes(YAML::NodeType::Map);
+    for (auto &&c : m_shard_of_cpp_class) {
+        classes.force_insert(c.first, c.second);
+    }
+    manifest["classes"] = classes;
+
+    auto manifest_format = m_format == spec_format::json ? spec_format::json : spec_format::yaml;
+    auto path = (filesystem::path(m_directory) / ("manifest." + spec_file_extension(manifest_format))).string();
+    ofstream out(path);
+    if (!out.is_open()) {
+        throw runtime_error("Unable to open " + path + " for writing");
+    }
+    if (manifest_format == spec_format::json) {
+        write_json(out, manifest);
+    } else {
+        YAML::Emitter y_out(out);
+        y_out << manifest;
+    }
+    out << endl;
+}
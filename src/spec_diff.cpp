@@ -0,0 +1,453 @@
+#include "spec_diff.hpp"
+#include "content_hash.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+    // The sections of a spec whose entries are matched by name, and the key holding the name.
+    struct named_section {
+        const char *section;
+        const char *name_key;
+    };
+    const named_section _g_collections{"collections", "collection_name"};
+    const named_section _g_classes{"classes", "cpp_name"};
+    const named_section _g_files{"files", "name"};
+
+    bool is_named_section(const string &key) {
+        return key == _g_collections.section || key == _g_classes.section || key == _g_files.section;
+    }
+
+    // Text that is the same for two nodes exactly when they hold the same data. Scalars
+    // are compared by their text only, so a json and a yaml spec can be compared.
+    void canonical_text(const YAML::Node &node, string &out) {
+        switch (node.Type()) {
+            case YAML::NodeType::Scalar:
+                out += 's';
+                out += to_string(node.Scalar().size());
+                out += ':';
+                out += node.Scalar();
+                break;
+            case YAML::NodeType::Sequence:
+                out += '[';
+                for (auto &&item : node) {
+                    canonical_text(item, out);
+                }
+                out += ']';
+                break;
+            case YAML::NodeType::Map:
+                out += '{';
+                for (auto &&item : node) {
+                    canonical_text(item.first, out);
+                    canonical_text(item.second, out);
+                }
+                out += '}';
+                break;
+            default:
+                out += 'n';
+                break;
+        }
+    }
+
+    bool same_node(const YAML::Node &a, const YAML::Node &b) {
+        string a_text, b_text;
+        canonical_text(a, a_text);
+        canonical_text(b, b_text);
+        return a_text == b_text;
+    }
+
+    string entry_name(const YAML::Node &entry, const named_section &s) {
+        auto name = entry[s.name_key];
+        if (!name || !name.IsScalar()) {
+            throw runtime_error(string("Entry in ") + s.section + " has no " + s.name_key + ".");
+        }
+        return name.Scalar();
+    }
+
+    // Index a section by name. Names must be unique.
+    unordered_map<string, YAML::Node> index_section(const YAML::Node &spec, const named_section &s) {
+        unordered_map<string, YAML::Node> result;
+        auto section = spec[s.section];
+        if (!section) {
+            return result;
+        }
+        result.reserve(section.size());
+        for (auto &&entry : section) {
+            if (!result.emplace(entry_name(entry, s), entry).second) {
+                throw runtime_error(string("Name '") + entry_name(entry, s) + "' is in " + s.section + " more than once.");
+            }
+        }
+        return result;
+    }
+
+    // Names of a section's entries, in order
+    vector<string> section_names(const YAML::Node &spec, const named_section &s) {
+        vector<string> result;
+        auto section = spec[s.section];
+        if (section) {
+            for (auto &&entry : section) {
+                result.push_back(entry_name(entry, s));
+            }
+        }
+        return result;
+    }
+
+    // The order a section is rebuilt in without an explicit one: entries that are still
+    // there keep their place and new ones are merged in by name - the order the generator
+    // writes collections and classes in.
+    vector<string> rebuilt_order(const vector<string> &old_names, const unordered_set<string> &removed,
+        const vector<string> &added_names)
+    {
+        vector<string> names;
+        for (auto &&name : old_names) {
+            if (removed.find(name) == removed.end()) {
+                names.push_back(name);
+            }
+        }
+        auto middle = names.size();
+        names.insert(names.end(), added_names.begin(), added_names.end());
+        inplace_merge(names.begin(), names.begin() + middle, names.end());
+        return names;
+    }
+
+    // Hash of everything in a spec, as loaded
+    string spec_fingerprint(const YAML::Node &spec) {
+        string text;
+        canonical_text(spec, text);
+        fnv1a_hash hash;
+        hash.add(text);
+        return hash.hex();
+    }
+
+    spec_section_diff diff_section(const YAML::Node &old_spec, const YAML::Node &new_spec, const named_section &s) {
+        spec_section_diff result;
+        auto old_entries = index_section(old_spec, s);
+
+        unordered_set<string> new_names;
+        auto new_section = new_spec[s.section];
+        if (new_section) {
+            for (auto &&entry : new_section) {
+                auto name = entry_name(entry, s);
+                new_names.insert(name);
+                auto old_entry = old_entries.find(name);
+                if (old_entry == old_entries.end()) {
+                    result.added.push_back(entry);
+                } else if (!same_node(old_entry->second, entry)) {
+                    result.changed.push_back(spec_entry_change{old_entry->second, entry});
+                }
+            }
+        }
+
+        auto old_section = old_spec[s.section];
+        if (old_section) {
+            for (auto &&entry : old_section) {
+                auto name = entry_name(entry, s);
+                if (new_names.find(name) == new_names.end()) {
+                    result.removed.push_back(name);
+                }
+            }
+        }
+
+        // Only record the order if the patch could not rebuild it
+        vector<string> added_names;
+        for (auto &&e : result.added) {
+            added_names.push_back(entry_name(e, s));
+        }
+        unordered_set<string> removed(result.removed.begin(), result.removed.end());
+        auto new_order = section_names(new_spec, s);
+        if (rebuilt_order(section_names(old_spec, s), removed, added_names) != new_order) {
+            result.order = new_order;
+        }
+        return result;
+    }
+
+    YAML::Node section_patch(const spec_section_diff &diff) {
+        YAML::Node result(YAML::NodeType::Map);
+        for (auto &&e : diff.added) {
+            result["added"].push_back(e);
+        }
+        for (auto &&e : diff.removed) {
+            result["removed"].push_back(e);
+        }
+        for (auto &&e : diff.changed) {
+            result["changed"].push_back(e.after);
+        }
+        for (auto &&name : diff.order) {
+            result["order"].push_back(name);
+        }
+        return result;
+    }
+
+    // Build the new version of a section, in the patch's order if it has one (see `rebuilt_order`).
+    YAML::Node apply_section_patch(const YAML::Node &old_spec, const YAML::Node &patch, const named_section &s)
+    {
+        auto entries = index_section(old_spec, s);
+        auto old_names = section_names(old_spec, s);
+
+        auto s_patch = patch[s.section];
+        if (s_patch && s_patch["removed"]) {
+            for (auto &&name : s_patch["removed"]) {
+                if (entries.erase(name.Scalar()) == 0) {
+                    throw runtime_error(string("Patch removes '") + name.Scalar() + "' from " + s.section + ", but it is not there.");
+                }
+            }
+        }
+        if (s_patch && s_patch["changed"]) {
+            for (auto &&entry : s_patch["changed"]) {
+                auto itr = entries.find(entry_name(entry, s));
+                if (itr == entries.end()) {
+                    throw runtime_error(string("Patch changes '") + entry_name(entry, s) + "' in " + s.section + ", but it is not there.");
+                }
+                itr->second.reset(entry);
+            }
+        }
+        vector<string> added_names;
+        if (s_patch && s_patch["added"]) {
+            for (auto &&entry : s_patch["added"]) {
+                auto name = entry_name(entry, s);
+                if (!entries.emplace(name, entry).second) {
+                    throw runtime_error(string("Patch adds '") + name + "' to " + s.section + ", but it is already there.");
+                }
+                added_names.push_back(name);
+            }
+        }
+
+        vector<string> names;
+        if (s_patch && s_patch["order"]) {
+            names = s_patch["order"].as<vector<string>>();
+            if (names.size() != entries.size()) {
+                throw runtime_error(string("Patch order for ") + s.section + " does not match its entries.");
+            }
+        } else {
+            unordered_set<string> removed;
+            for (auto &&name : old_names) {
+                if (entries.find(name) == entries.end()) {
+                    removed.insert(name);
+                }
+            }
+            names = rebuilt_order(old_names, removed, added_names);
+        }
+
+        YAML::Node result(YAML::NodeType::Sequence);
+        for (auto &&name : names) {
+            auto itr = entries.find(name);
+            if (itr == entries.end()) {
+                throw runtime_error(string("Patch order for ") + s.section + " names unknown entry '" + name + "'.");
+            }
+            result.push_back(itr->second);
+        }
+        return result;
+    }
+
+    // name(arg types) - enough to tell overloads apart
+    string method_signature(const YAML::Node &m) {
+        string result = m["name"].as<string>("") + "(";
+        bool first = true;
+        for (auto &&arg : m["arguments"]) {
+            if (!first) {
+                result += ", ";
+            }
+            first = false;
+            result += arg["type"].as<string>("");
+        }
+        return result + ")";
+    }
+
+    void write_section_summary(ostream &out, const char *title, const spec_section_diff &diff, const named_section &s) {
+        if (diff.empty()) {
+            return;
+        }
+        out << title << ": " << diff.added.size() << " added, " << diff.removed.size() << " removed, "
+            << diff.changed.size() << " changed" << endl;
+        for (auto &&e : diff.added) {
+            out << "  + " << entry_name(e, s) << endl;
+        }
+        for (auto &&name : diff.removed) {
+            out << "  - " << name << endl;
+        }
+        for (auto &&c : diff.changed) {
+            out << "  ~ " << entry_name(c.after, s) << endl;
+        }
+        if (diff.order.size() > 0) {
+            out << "  order changed" << endl;
+        }
+    }
+}
+
+bool spec_diff::empty() const
+{
+    return collections.empty() && classes.empty() && files.empty()
+        && top_level_changed.empty() && top_level_removed.empty();
+}
+
+spec_diff diff_specs(const YAML::Node &old_spec, const YAML::Node &new_spec)
+{
+    spec_diff result;
+    result.collections = diff_section(old_spec, new_spec, _g_collections);
+    result.classes = diff_section(old_spec, new_spec, _g_classes);
+    result.files = diff_section(old_spec, new_spec, _g_files);
+
+    for (auto &&item : new_spec) {
+        auto key = item.first.Scalar();
+        if (is_named_section(key)) {
+            continue;
+        }
+        auto old_item = old_spec[key];
+        if (!old_item || !same_node(old_item, item.second)) {
+            result.top_level_changed.emplace(key, item.second);
+        }
+    }
+    for (auto &&item : old_spec) {
+        auto key = item.first.Scalar();
+        if (!is_named_section(key) && !new_spec[key]) {
+            result.top_level_removed.push_back(key);
+        }
+    }
+
+    if (old_spec["config"] && old_spec["config"]["content_hash"]) {
+        result.base_content_hash = old_spec["config"]["content_hash"].as<string>();
+    } else {
+        result.base_fingerprint = spec_fingerprint(old_spec);
+    }
+    return result;
+}
+
+YAML::Node spec_patch(const spec_diff &diff)
+{
+    YAML::Node result(YAML::NodeType::Map);
+    if (diff.base_content_hash.size() > 0) {
+        result["base_content_hash"] = diff.base_content_hash;
+    }
+    if (diff.base_fingerprint.size() > 0) {
+        result["base_fingerprint"] = diff.base_fingerprint;
+    }
+    result[_g_collections.section] = section_patch(diff.collections);
+    result[_g_classes.section] = section_patch(diff.classes);
+    result[_g_files.section] = section_patch(diff.files);
+    for (auto &&item : diff.top_level_changed) {
+        result["set"][item.first] = item.second;
+    }
+    for (auto &&key : diff.top_level_removed) {
+        result["unset"].push_back(key);
+    }
+    return result;
+}
+
+YAML::Node apply_spec_patch(const YAML::Node &old_spec, const YAML::Node &patch)
+{
+    if (patch["base_content_hash"]) {
+        auto old_config = old_spec["config"];
+        auto old_hash = old_config && old_config["content_hash"] ? old_config["content_hash"].as<string>() : string();
+        if (old_hash != patch["base_content_hash"].as<string>()) {
+            throw runtime_error("Patch was made from a spec with content hash " + patch["base_content_hash"].as<string>()
+                + ", but this spec has '" + old_hash + "'.");
+        }
+    } else if (patch["base_fingerprint"]) {
+        if (spec_fingerprint(old_spec) != patch["base_fingerprint"].as<string>()) {
+            throw runtime_error("Patch was made from a different spec (fingerprint " + patch["base_fingerprint"].as<string>() + ").");
+        }
+    } else {
+        throw runtime_error("Patch does not say which spec it was made from (no base_content_hash or base_fingerprint).");
+    }
+
+    const named_section sections[] = {_g_collections, _g_classes, _g_files};
+    set<string> unset;
+    if (patch["unset"]) {
+        auto keys = patch["unset"].as<vector<string>>();
+        unset.insert(keys.begin(), keys.end());
+    }
+    auto set_keys = patch["set"];
+
+    // Keep the top level keys in the old order, with new ones at the end.
+    YAML::Node result(YAML::NodeType::Map);
+    set<string> done;
+    auto add_key = [&](const string &key) {
+        if (unset.find(key) != unset.end() || !done.insert(key).second) {
+            return;
+        }
+        for (auto &&s : sections) {
+            if (key == s.section) {
+                result[key] = apply_section_patch(old_spec, patch, s);
+                return;
+            }
+        }
+        if (set_keys && set_keys[key]) {
+            result[key] = set_keys[key];
+        } else if (old_spec[key]) {
+            result[key] = old_spec[key];
+        }
+    };
+    for (auto &&item : old_spec) {
+        add_key(item.first.Scalar());
+    }
+    for (auto &&s : sections) {
+        auto s_patch = patch[s.section];
+        if (!old_spec[s.section] && s_patch && s_patch["added"]) {
+            add_key(s.section);
+        }
+    }
+    if (set_keys) {
+        for (auto &&item : set_keys) {
+            add_key(item.first.Scalar());
+        }
+    }
+    return result;
+}
+
+void write_spec_diff_summary(ostream &out, const spec_diff &diff)
+{
+    if (diff.empty()) {
+        out << "No differences." << endl;
+        return;
+    }
+
+    write_section_summary(out, "Collections", diff.collections, _g_collections);
+    write_section_summary(out, "Files", diff.files, _g_files);
+    for (auto &&item : diff.top_level_changed) {
+        out << "Changed: " << item.first << endl;
+    }
+    for (auto &&key : diff.top_level_removed) {
+        out << "Removed: " << key << endl;
+    }
+
+    write_section_summary(out, "Classes", diff.classes, _g_classes);
+    for (auto &&c : diff.classes.changed) {
+        unordered_set<string> old_methods, new_methods;
+        for (auto &&m : c.before["methods"]) {
+            old_methods.insert(method_signature(m));
+        }
+        for (auto &&m : c.after["methods"]) {
+            new_methods.insert(method_signature(m));
+        }
+
+        vector<string> added, removed;
+        for (auto &&m : c.after["methods"]) {
+            auto sig = method_signature(m);
+            if (old_methods.find(sig) == old_methods.end()) {
+                added.push_back(sig);
+            }
+        }
+        for (auto &&m : c.before["methods"]) {
+            auto sig = method_signature(m);
+            if (new_methods.find(sig) == new_methods.end()) {
+                removed.push_back(sig);
+            }
+        }
+        if (added.size() == 0 && removed.size() == 0) {
+            continue;
+        }
+
+        out << "  " << entry_name(c.after, _g_classes) << ":" << endl;
+        for (auto &&m : added) {
+            out << "    + " << m << endl;
+        }
+        for (auto &&m : removed) {
+            out << "    - " << m << endl;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#include "spec_writer.hpp"
+#include "yaml_spec_writer.hpp"
+#include "json_spec_writer.hpp"
+#include "binary_spec_writer.hpp"
+
+using namespace std;
+
+unique_ptr<spec_writer> make_spec_writer(spec_format format, ostream &out)
+{
+    switch (format) {
+        case spec_format::json:
+            return make_unique<json_spec_writer>(out);
+        case spec_format::binary:
+            return make_unique<binary_spec_writer>(out);
+        case spec_format::yaml:
+        default:
+            return make_unique<yaml_spec_writer>(out);
+    }
+}
+
+string spec_file_extension(spec_format format)
+{
+    switch (format) {
+        case spec_format::json:
+            return "json";
+        case spec_format::binary:
+            return "bin";
+        case spec_format::yaml:
+        default:
+            return "yaml";
+    }
+}
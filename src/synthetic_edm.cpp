@@ -0,0 +1,243 @@
+#include "synthetic_edm.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+    // The base classes are in this many independent chains.
+    const int _g_base_families = 10;
+
+    string base_name(int family, int level) {
+        return "Base" + to_string(family) + "_" + to_string(level);
+    }
+
+    // Short name (no namespace) of a class
+    string class_short_name(int index) {
+        return "Class" + to_string(index) + "_v1";
+    }
+
+    // vector<vector<...<inner>...>> with `depth` vectors
+    string nested_vector(const string &inner, int depth) {
+        string result = inner;
+        for (int i = 0; i < depth; i++) {
+            result = "std::vector<" + result + (result.back() == '>' ? " >" : ">");
+        }
+        return result;
+    }
+
+    ofstream open_output(const fs::path &path) {
+        ofstream out(path);
+        if (!out) {
+            throw runtime_error("Unable to write synthetic EDM file " + path.string());
+        }
+        return out;
+    }
+
+    // The container templates and the base classes
+    void write_common_header(const synthetic_edm_config &config, const fs::path &path) {
+        auto out = open_output(path);
+        out << "#ifndef __SyntheticEDM_Common__" << endl;
+        out << "#define __SyntheticEDM_Common__" << endl;
+        out << endl;
+        out << "#include <vector>" << endl;
+        out << "#include <string>" << endl;
+        out << "#include <cstddef>" << endl;
+        out << endl;
+        out << "// Stand ins for the xAOD container and link templates" << endl;
+        out << "template <class T>" << endl;
+        out << "class DataVector {" << endl;
+        out << "public:" << endl;
+        out << "    typedef T* const* const_iterator;" << endl;
+        out << "    const_iterator begin() const { return m_items.data(); }" << endl;
+        out << "    const_iterator end() const { return m_items.data() + m_items.size(); }" << endl;
+        out << "    std::size_t size() const { return m_items.size(); }" << endl;
+        out << "    const T* at(std::size_t index) const { return m_items.at(index); }" << endl;
+        out << "private:" << endl;
+        out << "    std::vector<T*> m_items; //!" << endl;
+        out << "};" << endl;
+        out << endl;
+        out << "template <class C>" << endl;
+        out << "class ElementLink {" << endl;
+        out << "public:" << endl;
+        out << "    bool isValid() const { return m_index != static_cast<std::size_t>(-1); }" << endl;
+        out << "    std::size_t index() const { return m_index; }" << endl;
+        out << "    const std::string &dataID() const { return m_key; }" << endl;
+        out << "private:" << endl;
+        out << "    std::string m_key; //!" << endl;
+        out << "    std::size_t m_index = static_cast<std::size_t>(-1); //!" << endl;
+        out << "};" << endl;
+        out << endl;
+        out << "namespace " << config.name_space << " {" << endl;
+        for (int family = 0; family < _g_base_families; family++) {
+            for (int level = 0; level < config.inheritance_depth; level++) {
+                out << "    class " << base_name(family, level);
+                if (level > 0) {
+                    out << " : public " << base_name(family, level - 1);
+                }
+                out << " {" << endl;
+                out << "    public:" << endl;
+                out << "        virtual ~" << base_name(family, level) << "() {}" << endl;
+                out << "        float level" << level << "_value() const { return m_value; }" << endl;
+                out << "    private:" << endl;
+                out << "        float m_value = 0; //!" << endl;
+                out << "    };" << endl;
+            }
+        }
+        out << "}" << endl;
+        out << endl;
+        out << "#endif" << endl;
+    }
+
+    void write_class(const synthetic_edm_config &config, int index, ostream &out) {
+        auto name = class_short_name(index);
+        out << "    class " << name;
+        if (config.inheritance_depth > 0) {
+            out << " : public " << base_name(index % _g_base_families, config.inheritance_depth - 1);
+        }
+        out << " {" << endl;
+        out << "    public:" << endl;
+
+        for (int e = 0; e < config.enums_per_class; e++) {
+            out << "        enum Kind" << e << " { kind" << e << "_first = 0, kind" << e << "_second = 1, kind" << e << "_third = 2 };" << endl;
+            out << "        Kind" << e << " kind" << e << "() const { return kind" << e << "_first; }" << endl;
+        }
+
+        out << "        double pt() const { return m_pt; }" << endl;
+        out << "        double eta() const { return m_eta; }" << endl;
+        out << "        int index() const { return " << index << "; }" << endl;
+        out << "        " << nested_vector("float", config.template_depth) << " nested() const { return {}; }" << endl;
+
+        // Links to the children, which is how discovery finds every class.
+        for (int child = 2 * index + 1; child <= 2 * index + 2 && child < config.n_classes; child++) {
+            auto child_container = "DataVector<" + config.name_space + "::" + class_short_name(child) + ">";
+            auto child_link = "ElementLink<" + child_container + " >";
+            out << "        const " << child_container << " &children" << child << "() const { return m_children" << child << "; }" << endl;
+            out << "        " << child_link << " link" << child << "() const { return {}; }" << endl;
+            out << "        " << nested_vector(child_link, max(1, config.template_depth)) << " links" << child << "() const { return {}; }" << endl;
+        }
+
+        out << "    private:" << endl;
+        out << "        double m_pt = 0; //!" << endl;
+        out << "        double m_eta = 0; //!" << endl;
+        for (int child = 2 * index + 1; child <= 2 * index + 2 && child < config.n_classes; child++) {
+            out << "        DataVector<" << config.name_space << "::" << class_short_name(child) << "> m_children" << child << "; //!" << endl;
+        }
+        out << "    };" << endl;
+        out << "    typedef DataVector<" << name << "> Class" << index << "Container;" << endl;
+    }
+
+    void write_classes_header(const synthetic_edm_config &config, int header_index, const fs::path &path) {
+        auto out = open_output(path);
+        auto guard = "__SyntheticEDM_Classes" + to_string(header_index) + "__";
+        out << "#ifndef " << guard << endl;
+        out << "#define " << guard << endl;
+        out << endl;
+        out << "#include \"SyntheticEDM/Common.h\"" << endl;
+        out << endl;
+
+        auto first = header_index * config.classes_per_header;
+        auto last = min(config.n_classes, first + config.classes_per_header);
+        out << "namespace " << config.name_space << " {" << endl;
+        // Children always come after their parent, so they all need declaring up front.
+        for (int i = first; i < last; i++) {
+            for (int child = 2 * i + 1; child <= 2 * i + 2 && child < config.n_classes; child++) {
+                out << "    class " << class_short_name(child) << ";" << endl;
+            }
+        }
+        for (int i = first; i < last; i++) {
+            write_class(config, i, out);
+        }
+        out << "}" << endl;
+        out << endl;
+        out << "#endif" << endl;
+    }
+
+    // The seed class, which leads to all the others.
+    void write_event_header(const synthetic_edm_config &config, const fs::path &path) {
+        auto out = open_output(path);
+        out << "#ifndef __SyntheticEDM_Event__" << endl;
+        out << "#define __SyntheticEDM_Event__" << endl;
+        out << endl;
+        out << "#include \"SyntheticEDM/Common.h\"" << endl;
+        out << endl;
+        out << "namespace " << config.name_space << " {" << endl;
+        if (config.n_classes > 0) {
+            out << "    class " << class_short_name(0) << ";" << endl;
+        }
+        out << "    class Event_v1 {" << endl;
+        out << "    public:" << endl;
+        out << "        unsigned long long eventNumber() const { return 0; }" << endl;
+        if (config.n_classes > 0) {
+            out << "        const DataVector<" << config.name_space << "::" << class_short_name(0) << "> &roots() const { return m_roots; }" << endl;
+            out << "    private:" << endl;
+            out << "        DataVector<" << config.name_space << "::" << class_short_name(0) << "> m_roots; //!" << endl;
+        }
+        out << "    };" << endl;
+        out << "}" << endl;
+        out << endl;
+        out << "#endif" << endl;
+    }
+
+    void write_linkdef(const synthetic_edm_config &config, const fs::path &path) {
+        auto out = open_output(path);
+        auto &&ns = config.name_space;
+        out << "#ifdef __CLING__" << endl;
+        out << "#pragma link off all globals;" << endl;
+        out << "#pragma link off all classes;" << endl;
+        out << "#pragma link off all functions;" << endl;
+        out << "#pragma link C++ nestedclasses;" << endl;
+        out << "#pragma link C++ namespace " << ns << ";" << endl;
+        for (int family = 0; family < _g_base_families; family++) {
+            for (int level = 0; level < config.inheritance_depth; level++) {
+                out << "#pragma link C++ class " << ns << "::" << base_name(family, level) << "+;" << endl;
+            }
+        }
+        for (int i = 0; i < config.n_classes; i++) {
+            auto name = ns + "::" + class_short_name(i);
+            out << "#pragma link C++ class " << name << "+;" << endl;
+            out << "#pragma link C++ class DataVector<" << name << ">+;" << endl;
+            out << "#pragma link C++ class ElementLink<DataVector<" << name << "> >+;" << endl;
+            out << "#pragma link C++ typedef " << ns << "::Class" << i << "Container;" << endl;
+        }
+        out << "#pragma link C++ class " << ns << "::Event_v1+;" << endl;
+        out << "#endif" << endl;
+    }
+}
+
+string synthetic_edm_class_name(const synthetic_edm_config &config, int index)
+{
+    return config.name_space + "::" + class_short_name(index);
+}
+
+vector<string> synthetic_edm_headers(const synthetic_edm_config &config)
+{
+    vector<string> result{"SyntheticEDM/Common.h"};
+    auto n_headers = (config.n_classes + config.classes_per_header - 1) / config.classes_per_header;
+    for (int i = 0; i < n_headers; i++) {
+        result.push_back("SyntheticEDM/Classes" + to_string(i) + ".h");
+    }
+    result.push_back("SyntheticEDM/Event.h");
+    return result;
+}
+
+void write_synthetic_edm(const synthetic_edm_config &config, const string &directory)
+{
+    if (config.n_classes < 0 || config.classes_per_header <= 0 || config.inheritance_depth < 0 || config.template_depth < 0) {
+        throw runtime_error("Bad synthetic EDM configuration: class counts and depths must not be negative.");
+    }
+
+    fs::path dir(directory);
+    fs::create_directories(dir / "SyntheticEDM");
+
+    auto headers = synthetic_edm_headers(config);
+    write_common_header(config, dir / headers.front());
+    for (size_t i = 1; i + 1 < headers.size(); i++) {
+        write_classes_header(config, static_cast<int>(i - 1), dir / headers[i]);
+    }
+    write_event_header(config, dir / headers.back());
+    write_linkdef(config, dir / "LinkDef.h");
+}
@@ -0,0 +1,110 @@
+#include "trace.hpp"
+#include "json_spec_writer.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+    atomic<trace_recorder*> _g_active_trace(nullptr);
+
+    double us_between(chrono::steady_clock::time_point start, chrono::steady_clock::time_point end) {
+        return chrono::duration<double, micro>(end - start).count();
+    }
+}
+
+trace_recorder *active_trace()
+{
+    return _g_active_trace.load(memory_order_relaxed);
+}
+
+trace_recorder *set_active_trace(trace_recorder *trace)
+{
+    return _g_active_trace.exchange(trace);
+}
+
+trace_recorder::trace_recorder()
+    : m_start(chrono::steady_clock::now())
+{
+    // The thread that starts the trace is thread 0
+    m_threads[this_thread::get_id()] = 0;
+}
+
+int trace_recorder::thread_index(thread::id id)
+{
+    auto itr = m_threads.find(id);
+    if (itr != m_threads.end()) {
+        return itr->second;
+    }
+    int index = static_cast<int>(m_threads.size());
+    m_threads[id] = index;
+    return index;
+}
+
+void trace_recorder::add(const string &name, const string &category, const string &detail,
+    chrono::steady_clock::time_point start, chrono::steady_clock::time_point end)
+{
+    trace_event e;
+    e.name = name;
+    e.category = category;
+    e.detail = detail;
+    e.start_us = us_between(m_start, start);
+    e.duration_us = us_between(start, end);
+
+    lock_guard<mutex> guard(m_lock);
+    e.thread = thread_index(this_thread::get_id());
+    m_events.push_back(move(e));
+}
+
+vector<trace_event> trace_recorder::events() const
+{
+    lock_guard<mutex> guard(m_lock);
+    return m_events;
+}
+
+void trace_recorder::write(ostream &out) const
+{
+    auto all_events = events();
+    int n_threads;
+    {
+        lock_guard<mutex> guard(m_lock);
+        n_threads = static_cast<int>(m_threads.size());
+    }
+
+    // Viewers do not need them in order, but it makes the file easier to read.
+    stable_sort(all_events.begin(), all_events.end(), [](const trace_event &a, const trace_event &b) {
+        return a.start_us < b.start_us;
+    });
+
+    auto old_flags = out.flags();
+    auto old_precision = out.precision();
+    out << fixed << setprecision(3);
+
+    out << "{\"traceEvents\": [" << endl;
+    for (int i = 0; i < n_threads; i++) {
+        out << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i
+            << ", \"args\": {\"name\": \"" << (i == 0 ? string("main") : "worker " + to_string(i)) << "\"}}";
+        out << ((i + 1 < n_threads || all_events.size() > 0) ? "," : "") << endl;
+    }
+    for (size_t i = 0; i < all_events.size(); i++) {
+        auto &&e = all_events[i];
+        out << "  {\"name\": ";
+        write_json_string(out, e.name);
+        out << ", \"cat\": ";
+        write_json_string(out, e.category);
+        out << ", \"ph\": \"X\", \"ts\": " << e.start_us << ", \"dur\": " << e.duration_us
+            << ", \"pid\": 1, \"tid\": " << e.thread;
+        if (e.detail.size() > 0) {
+            out << ", \"args\": {\"detail\": ";
+            write_json_string(out, e.detail);
+            out << "}";
+        }
+        out << "}" << (i + 1 < all_events.size() ? "," : "") << endl;
+    }
+    out << "], \"displayTimeUnit\": \"ms\"}" << endl;
+
+    out.flags(old_flags);
+    out.precision(old_precision);
+}
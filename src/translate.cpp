@@ -2,14 +2,11 @@
 #include "normalize.hpp"
 #include "type_helpers.hpp"
 #include "util_string.hpp"
+#include "trace.hpp"
+#include "translate_profile.hpp"
+#include "run_stats.hpp"
 
-#include "TSystem.h"
-#include "TClass.h"
-#include "TBaseClass.h"
-#include "TMethod.h"
-#include "TMethodArg.h"
-#include "TEnum.h"
-#include "TEnumConstant.h"
+#include "reflection_provider.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -22,74 +19,54 @@
 
 using namespace std;
 
-int _g_no_name_arg_index = 0;
-
 set<string> reserved_words = {"from"};
 
 ///
-// Translate a method argument.
-method_arg translate_argument(const TMethodArg *arg){
-    auto result = method_arg();
-
-	result.name = arg->GetName();
-	result.raw_typename = arg->GetTypeName();
-	result.full_typename = arg->GetFullTypeName();
-
-    // Some arguments have no name to them
-    if (result.name.size() == 0) {
-        if (_g_no_name_arg_index == 0) {
-            result.name = "noname_arg";
-        } else {
-            ostringstream arg_name;
-            arg_name << "noname_arg_" << _g_no_name_arg_index;
-            result.name = arg_name.str();
+// Name the arguments of a method. Some arguments have no name, and
+// some have names that are reserved words in python.
+void fix_argument_names(method_info &m) {
+    int no_name_arg_index = 0;
+    for (auto &&arg : m.arguments)
+    {
+        if (arg.name.size() == 0) {
+            if (no_name_arg_index == 0) {
+                arg.name = "noname_arg";
+            } else {
+                ostringstream arg_name;
+                arg_name << "noname_arg_" << no_name_arg_index;
+                arg.name = arg_name.str();
+            }
+            no_name_arg_index++;
+        } else if (reserved_words.find(arg.name) != reserved_words.end()) {
+            arg.name += "_arg";
         }
-        _g_no_name_arg_index++;
-    } else if (reserved_words.find(result.name) != reserved_words.end()) {
-        result.name += "_arg";
     }
-
-    return result;
 }
 
 ///
 // Translate a method
-method_info translate_method(TMethod *method) {
-    method_info m;
-
-    // Get the method name
-    m.name = method->GetName();
-
-    // Get the method return type
-    m.return_type = method->GetReturnTypeName();
+method_info translate_method(method_info m) {
     if (m.return_type == "void") {
         m.return_type = "";
     }
-
-    // The arguments for the method
-    auto l = method->GetListOfMethodArgs();
-    _g_no_name_arg_index = 0;
-	for (int i_arg = 0; i_arg < l->GetSize(); i_arg++) {
-        m.arguments.push_back(translate_argument(static_cast<TMethodArg*> (l->At(i_arg))));
-	}
-
+    fix_argument_names(m);
     return m;
 }
 
-bool is_good_method(const string &class_name, const TMethod *m_info, const set<string> &inherited_classes) {
-    if (string(m_info->GetName()) == class_name) {
+bool is_good_method(const string &class_name, const method_info &m_info, const set<string> &inherited_classes) {
+    if (m_info.name == class_name) {
         return false;
     }
     
-    if (m_info->GetName()[0] == '~') {
+    if (m_info.name[0] == '~') {
         return false;
     }
 
-    if (string(m_info->GetName()).rfind("operator", 0) == 0) {
+    if (m_info.name.rfind("operator", 0) == 0) {
         return false;
     }
     
-    if (inherited_classes.find(m_info->GetName()) != inherited_classes.end()) {
+    if (inherited_classes.find(m_info.name) != inherited_classes.end()) {
         return false;
     }
 
@@ -98,31 +75,8 @@ bool is_good_method(const string &class_name, const TMethod *m_info, const set<s
 
 ///
 // Get all publicly directly inherited classes
-vector<string> inherited_public_classes(TClass *c_info) {
-    auto inherited_list = c_info->GetListOfBases();
-    TIter next(inherited_list);
-    vector<string> result;
-    while (auto bobj = static_cast<TBaseClass *>(next()))
-    {
-        // Do not grab private or protected inheritance. Only the public
-        // interface for us.
-        if (
-            ((bobj->Property() & kIsPrivate) == 0) && ((bobj->Property() & kIsProtected) == 0))
-        {
-            auto cl = bobj->GetClassPointer();
-            result.push_back(cl->GetName());
-        }
-    }
-    return result;
-}
-
 vector<string> inherited_public_classes(const std::string &cls_name) {
-    auto c_info = get_tclass(cls_name);
-    if (c_info != nullptr) {
-        return inherited_public_classes(c_info);
-    } else {
-        return vector<string>();
-    }
+    return reflection().public_bases(cls_name);
 }
 
 ///
@@ -162,43 +116,37 @@ string clean_so_name(string original_name)
 
 // Return the include file name for a particular class. Using some
 // heuristics to get it right.
-string get_include_file_for_class(const string &class_name)
+string get_include_file_for_class(const reflected_class &c_info)
 {
-    auto c_info = get_tclass(class_name);
-    if (c_info == nullptr) {
-        return "";
-    }
-    if ((c_info->GetDeclFileName() != nullptr) && c_info->GetSharedLibs() != nullptr) {
-        string shared_lib_name = clean_so_name(c_info->GetSharedLibs());
-        string decl_name = c_info->GetDeclFileName();
+    if (c_info.declaration_file.size() > 0 && c_info.library.size() > 0) {
+        string shared_lib_name = clean_so_name(c_info.library);
+        string decl_name = c_info.declaration_file;
         // Sometimes the library name is there already
         //  ATLAS R21 - the library name is not in the decl name
         //  ATLAS R22 - the library name is in the decl name
         if (decl_name.rfind(shared_lib_name, 0) == 0) {
             return decl_name;
         }
-        return string(clean_so_name(c_info->GetSharedLibs())) + "/" + c_info->GetDeclFileName();
+        return shared_lib_name + "/" + decl_name;
     }
     return "";
 }
 
 // Take the interior object, and rename as a container
-string get_include_file_for_container(const string &class_name, const string &raw_object_name)
+string get_include_file_for_container(const reflected_class &c_info, const string &raw_object_name)
 {
     auto object_name = std::regex_replace(raw_object_name, std::regex("_v[0-9]+$"), "");
     auto parsed_info = parse_typename(object_name);
 
-    auto c_info = get_tclass(class_name);
-    if (c_info == nullptr) {
+    if (c_info.name.size() == 0) {
         return "";
     }
-    return string(clean_so_name(c_info->GetSharedLibs())) + "/" + parsed_info.type_name + "Container.h";
+    return clean_so_name(c_info.library) + "/" + parsed_info.type_name + "Container.h";
 }
 
 bool include_file_exists(const string &include_path) {
-    string full = "$ROOTCOREDIR/include/" + include_path;
-    string expanded = gSystem->ExpandPathName(full.c_str());
-    return !gSystem->AccessPathName(expanded.c_str(), kFileExists);
+    add_count(run_counter::include_file_checks);
+    return reflection().include_file_exists(include_path);
 }
 
 // Make sure any type template arguments are loaded. If they
@@ -210,49 +158,19 @@ bool load_template_arguments(const vector<typename_info> &types) {
     // Gets around ROOT failing to load ElementLink<xAOD::MuonContainer>
     // even though it knows about all of that.
 
-    // Some base types that aren't classes but are well known.
-    static set<string> base_types;
-    if (base_types.size() == 0) {
-        base_types.insert("int");
-        base_types.insert("float");
-        base_types.insert("double");
-        base_types.insert("bool");
-        base_types.insert("string");
-        base_types.insert("char");
-        base_types.insert("unsigned char");
-        base_types.insert("signed char");
-        base_types.insert("short");
-        base_types.insert("unsigned short");
-        base_types.insert("unsigned int");
-        base_types.insert("long");
-        base_types.insert("unsigned long");
-        base_types.insert("long long");
-        base_types.insert("unsigned long long");
-        base_types.insert("char16_t");
-        base_types.insert("char32_t");
-        base_types.insert("uint");
-        base_types.insert("uint8_t");
-        base_types.insert("uint16_t");
-        base_types.insert("uint32_t");
-        base_types.insert("uint64_t");
-        base_types.insert("int8_t");
-        base_types.insert("int16_t");
-        base_types.insert("int32_t");
-        base_types.insert("int64_t");
-    }
-
     for (auto &&t : types)
     {
-        if (base_types.find(t.type_name) != base_types.end()) {
+        // Some base types that aren't classes but are well known.
+        if (is_fundamental_type(t.type_name)) {
             continue;
         }
-        if (get_tclass(unqualified_typename(t)) == nullptr)
+        if (reflection().class_name(unqualified_typename(t)).size() == 0)
         {
             // If we can't load it, then load template arguments first.
             if (!load_template_arguments(t.template_arguments)) {
                 return false;
             }
-            if (get_tclass(unqualified_typename(t)) == nullptr)
+            if (reflection().class_name(unqualified_typename(t)).size() == 0)
             {
                 return false;
             }
@@ -263,6 +181,9 @@ bool load_template_arguments(const vector<typename_info> &types) {
 
 class_info translate_class(const std::string &class_name)
 {
+    scoped_trace_span span("translate_class", "translate", class_name);
+    class_translate_stopwatch stopwatch(class_name);
+    add_count(run_counter::classes_translated);
     class_info result;
 
     // Recursively load the class - to make sure in templates everything
@@ -274,15 +195,14 @@ class_info translate_class(const std::string &class_name)
 
     // Get the class
     auto unq_class_name = unqualified_typename(t_prior);
-    auto c_info = get_tclass(unq_class_name);
-    if (c_info == nullptr)
+    string name = reflection().class_name(unq_class_name);
+    if (name.size() == 0)
     {
         std::cerr << "ERROR: Cannot translate class '" << class_name << "': ROOT's type system doesn't have it loaded as a class." << std::endl;
         return result;
     }
 
     // There are several other types of classes we do not need to translate as well.
-    string name = c_info->GetName();
     auto t = parse_typename(name);
     if (t.type_name.substr(0,2) == "__") {
         cerr << "INFO: Not translating '" << class_name << "' as it is a private internal class (" << t.type_name << ")" << endl;
@@ -302,7 +222,7 @@ class_info translate_class(const std::string &class_name)
         method_info size_method;
         size_method.name = "size";
         size_method.return_type = "size_t";
-        result.methods.push_back(size_method);
+        result.methods.push_back(move(size_method));
         return result;
     }
 
@@ -314,20 +234,22 @@ class_info translate_class(const std::string &class_name)
         method_info isValid_method;
         isValid_method.name = "isValid";
         isValid_method.return_type = "bool";
-        result.methods.push_back(isValid_method);
+        result.methods.push_back(move(isValid_method));
         result.class_behaviors.push_back(t.template_arguments[0].template_arguments[0].cpp_name + "**");
         return result;
     }
 
 
+    auto c_info = reflection().get_class(name);
+    stopwatch.lap(&class_translate_timing::lookup_seconds);
+
     // Library is just the clean so name for us
-    if (c_info->GetSharedLibs() != nullptr) {
-        result.library_name = clean_so_name(c_info->GetSharedLibs());
+    if (c_info.library.size() > 0) {
+        result.library_name = clean_so_name(c_info.library);
     }
 
     // Get all inherited classes
-    auto all_bases = inherited_public_classes(c_info);
-    for (auto &&b : all_bases)
+    for (auto &&b : c_info.public_bases)
     {
         result.inherited_class_names.push_back(b);
     }
@@ -338,38 +260,21 @@ class_info translate_class(const std::string &class_name)
     {
         set<string> seen_names;
         auto all_inherited = type_name(all_inherited_classes(unq_class_name));
-        auto all_methods = c_info->GetListOfAllPublicMethods();
-        TIter next(all_methods);
-        while (auto method = static_cast<TMethod *>(next.Next()))
+        for (auto &method : c_info.methods)
         {
-            if (seen_names.find(method->GetName()) == seen_names.end()) {
+            // Only the first method with a given name is considered.
+            if (seen_names.insert(method.name).second) {
                 if (is_good_method(t.type_name, method, all_inherited)) {
-                    result.methods.push_back(translate_method(method));
+                    result.methods.push_back(translate_method(move(method)));
                 }
             }
-            seen_names.insert(method->GetName());
         }
     }
+    stopwatch.lap(&class_translate_timing::methods_seconds);
 
     // Get all enums
-    auto all_enums = c_info->GetListOfEnums();
-    TIter next_enum(all_enums);
-    while (auto enum_obj = static_cast<TEnum *>(next_enum()))
-    {
-        enum_info e_info;
-        e_info.name = enum_obj->GetName();
-
-        // Get all the enum values
-        auto all_values = enum_obj->GetConstants();
-        TIter next_value(all_values);
-        while (auto value = static_cast<TEnumConstant *>(next_value()))
-        {
-            e_info.values.push_back(make_pair(value->GetName(), value->GetValue()));
-        }
-
-        // Save the result!
-        result.enums.push_back(e_info);
-    }
+    result.enums = move(c_info.enums);
+    stopwatch.lap(&class_translate_timing::enums_seconds);
 
     // Get include files associated with this class. This is quite messy, actually, because of the way
     // the modern root records where things are located, adn the fact we are dealing with typedef's.
@@ -378,19 +283,20 @@ class_info translate_class(const std::string &class_name)
     if (include == "") {
         auto dv_info = get_first_class(result, "DataVector");
         if (dv_info.cpp_name.size() > 0) {
-            include = get_include_file_for_container(class_name, dv_info.cpp_name);
+            include = get_include_file_for_container(c_info, dv_info.cpp_name);
             if (include.size() > 0 && !include_file_exists(include)) {
                 include = "";
             }
         }
     }
     if (include == "") {
-        include = get_include_file_for_class(class_name);
+        include = get_include_file_for_class(c_info);
         if (!include_file_exists(include)) {
             include = "";
         }
     }
     result.include_file = include;
+    stopwatch.lap(&class_translate_timing::include_seconds);
 
     // Some classes get special treatment b.c. the ROOT type system can't
     // do introspection.
@@ -405,19 +311,19 @@ class_info translate_class(const std::string &class_name)
         attr_name.name = "name";
         attr_name.full_typename = "string";
         attr_name.raw_typename = "string";
-        mi.arguments.push_back(attr_name);
+        mi.arguments.push_back(move(attr_name));
 
         method_arg attr_type;
         attr_type.name = "attribute_type";
         attr_type.full_typename = "cpp_type<U>";
         attr_type.raw_typename = "cpp_type<U>";
-        mi.parameter_arguments.push_back(attr_type);
+        mi.parameter_arguments.push_back(move(attr_type));
 
         mi.parameter_type_helper = "type_support.index_type_forwarder";
 
         mi.param_method_callback = "lambda s, a, param_1: {{package_name}}.type_support.cpp_generic_1arg_callback('getAttribute', s, a, param_1)";
 
-        result.methods.push_back(mi);
+        result.methods.push_back(move(mi));
     }
 
     auto all_inherited = all_inherited_classes(result.name);
@@ -433,19 +339,19 @@ class_info translate_class(const std::string &class_name)
             attr_name.name = "name";
             attr_name.full_typename = "string";
             attr_name.raw_typename = "string";
-            mi.arguments.push_back(attr_name);
+            mi.arguments.push_back(move(attr_name));
 
             method_arg attr_type;
             attr_type.name = "auxdata_type";
             attr_type.full_typename = "cpp_type<U>";
             attr_type.raw_typename = "cpp_type<U>";
-            mi.parameter_arguments.push_back(attr_type);
+            mi.parameter_arguments.push_back(move(attr_type));
 
             mi.parameter_type_helper = "type_support.index_type_forwarder";
 
             mi.param_method_callback = "lambda s, a, param_1: {{package_name}}.type_support.cpp_generic_1arg_callback('auxdataConst', s, a, param_1)";
 
-            result.methods.push_back(mi);
+            result.methods.push_back(move(mi));
         }
 
         // See if the aux data is present
@@ -458,21 +364,24 @@ class_info translate_class(const std::string &class_name)
             attr_name.name = "name";
             attr_name.full_typename = "string";
             attr_name.raw_typename = "string";
-            mi.arguments.push_back(attr_name);
+            mi.arguments.push_back(move(attr_name));
 
             method_arg attr_type;
             attr_type.name = "auxdata_type";
             attr_type.full_typename = "cpp_type<U>";
             attr_type.raw_typename = "cpp_type<U>";
-            mi.parameter_arguments.push_back(attr_type);
+            mi.parameter_arguments.push_back(move(attr_type));
 
             mi.parameter_type_helper = "type_support.index_type_forwarder";
 
             mi.param_method_callback = "lambda s, a, param_1: {{package_name}}.type_support.cpp_generic_1arg_callback('isAvailable', s, a, param_1)";
 
-            result.methods.push_back(mi);
+            result.methods.push_back(move(mi));
         }
     }
 
+    stopwatch.lap(&class_translate_timing::methods_seconds);
+    add_count(run_counter::methods_translated, result.methods.size());
+    add_count(run_counter::enums_translated, result.enums.size());
     return result;
 }
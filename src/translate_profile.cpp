@@ -0,0 +1,143 @@
+#include "translate_profile.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    atomic<translate_profile*> _g_active_profile(nullptr);
+
+    // Upper edges of the histogram buckets, in seconds. Anything slower goes in a last bucket.
+    const vector<double> _g_bucket_edges = {
+        10e-6, 30e-6, 100e-6, 300e-6, 1e-3, 3e-3, 10e-3, 30e-3, 100e-3, 300e-3, 1.0, 3.0
+    };
+
+    string format_seconds(double s) {
+        ostringstream out;
+        out << setprecision(3);
+        if (s < 1e-3) {
+            out << s * 1e6 << " us";
+        } else if (s < 1.0) {
+            out << s * 1e3 << " ms";
+        } else {
+            out << s << " s";
+        }
+        return out.str();
+    }
+}
+
+void translate_profile::add(const class_translate_timing &timing)
+{
+    lock_guard<mutex> guard(m_lock);
+    m_classes.push_back(timing);
+}
+
+vector<class_translate_timing> translate_profile::classes() const
+{
+    lock_guard<mutex> guard(m_lock);
+    return m_classes;
+}
+
+vector<class_translate_timing> translate_profile::slowest(size_t n) const
+{
+    auto result = classes();
+    auto by_total = [](const class_translate_timing &a, const class_translate_timing &b) {
+        return a.total_seconds() > b.total_seconds();
+    };
+    if (n < result.size()) {
+        partial_sort(result.begin(), result.begin() + n, result.end(), by_total);
+        result.resize(n);
+    } else {
+        sort(result.begin(), result.end(), by_total);
+    }
+    return result;
+}
+
+translate_profile *active_translate_profile()
+{
+    return _g_active_profile.load(memory_order_relaxed);
+}
+
+translate_profile *set_active_translate_profile(translate_profile *profile)
+{
+    return _g_active_profile.exchange(profile);
+}
+
+class_translate_stopwatch::class_translate_stopwatch(const string &class_name)
+    : m_profile(active_translate_profile())
+{
+    if (m_profile != nullptr) {
+        m_timing.name = class_name;
+        m_last = chrono::steady_clock::now();
+    }
+}
+
+class_translate_stopwatch::~class_translate_stopwatch()
+{
+    if (m_profile != nullptr) {
+        lap(&class_translate_timing::lookup_seconds);
+        m_profile->add(m_timing);
+    }
+}
+
+void class_translate_stopwatch::lap(double class_translate_timing::*step)
+{
+    if (m_profile == nullptr) {
+        return;
+    }
+    auto now = chrono::steady_clock::now();
+    m_timing.*step += chrono::duration<double>(now - m_last).count();
+    m_last = now;
+}
+
+void write_translate_histogram(ostream &out, const translate_profile &profile)
+{
+    auto all_classes = profile.classes();
+    vector<size_t> counts(_g_bucket_edges.size() + 1, 0);
+    double total = 0.0;
+    for (auto &&c : all_classes) {
+        auto t = c.total_seconds();
+        total += t;
+        auto bucket = upper_bound(_g_bucket_edges.begin(), _g_bucket_edges.end(), t) - _g_bucket_edges.begin();
+        counts[bucket]++;
+    }
+
+    out << "  " << all_classes.size() << " classes translated in " << format_seconds(total) << endl;
+    if (all_classes.size() == 0) {
+        return;
+    }
+
+    auto most = *max_element(counts.begin(), counts.end());
+    const size_t bar_width = 50;
+    for (size_t i = 0; i < counts.size(); i++) {
+        string label = i < _g_bucket_edges.size()
+            ? "< " + format_seconds(_g_bucket_edges[i])
+            : ">= " + format_seconds(_g_bucket_edges.back());
+        out << "  " << left << setw(10) << label << right << setw(8) << counts[i] << " "
+            << string(counts[i] * bar_width / most, '#') << endl;
+    }
+}
+
+void write_slowest_classes(ostream &out, const translate_profile &profile, size_t n)
+{
+    auto slow = profile.slowest(n);
+    size_t width = 5;
+    for (auto &&c : slow) {
+        width = max(width, c.name.size());
+    }
+
+    out << "  " << left << setw(width) << "class" << right
+        << setw(12) << "total" << setw(12) << "lookup" << setw(12) << "methods"
+        << setw(12) << "enums" << setw(12) << "include" << endl;
+    for (auto &&c : slow) {
+        out << "  " << left << setw(width) << c.name << right
+            << setw(12) << format_seconds(c.total_seconds())
+            << setw(12) << format_seconds(c.lookup_seconds)
+            << setw(12) << format_seconds(c.methods_seconds)
+            << setw(12) << format_seconds(c.enums_seconds)
+            << setw(12) << format_seconds(c.include_seconds) << endl;
+    }
+}
@@ -1,9 +1,9 @@
 #include "type_helpers.hpp"
 #include "class_info.hpp"
 #include "util_string.hpp"
+#include "run_stats.hpp"
 
-#include "TROOT.h"
-#include "TClassTable.h"
+#include "reflection_provider.hpp"
 
 #include <algorithm>
 #include <regex>
@@ -54,20 +54,25 @@ string unqualified_type_name(const string &full_type_name)
 // Find all classes that inherit from a given class name
 vector<string> all_that_inherit_from(const string &c_name)
 {
-    TClassTable::Init();
-    while (auto m_info = TClassTable::Next()) {
-        cout << "** " << m_info << endl;
-    }
-
-    TIter next(gROOT->GetListOfClasses());
+    auto &&provider = reflection();
     set<string> results;
-    while (auto c_info = static_cast<TClass *>(next()))
+    for (auto &&loaded : provider.loaded_classes())
     {
-        cout << " -> " << c_info->GetName() << endl;
-        if (c_info->InheritsFrom(c_name.c_str()))
-        {
-            results.insert(c_info->GetName());
-            cout << "    *** inherits!" << endl;
+        // Walk up the (public) bases
+        set<string> seen;
+        vector<string> to_do{loaded};
+        while (to_do.size() > 0) {
+            auto top = to_do.back();
+            to_do.pop_back();
+            if (!seen.insert(top).second) {
+                continue;
+            }
+            if (top == c_name) {
+                results.insert(loaded);
+                break;
+            }
+            auto bases = provider.public_bases(top);
+            to_do.insert(to_do.end(), bases.begin(), bases.end());
         }
     }
     return vector<string>(results.begin(), results.end());
@@ -80,18 +85,7 @@ void build_typedef_map() {
         return;
 
     // Build the forward map just once
-	TIter i_typedef (gROOT->GetListOfTypes(true));
-	int junk = gROOT->GetListOfTypes()->GetEntries();
-	TDataType *typedef_spec;
-	while ((typedef_spec = static_cast<TDataType*>(i_typedef.Next())) != 0)
-	{
-		string typedef_name = typedef_spec->GetName();
-		string base_name = typedef_spec->GetFullTypeName();
-
-        if (typedef_name != base_name) {
-            g_typedef_map[typedef_name] = base_name;
-        }
-    }
+    g_typedef_map = reflection().typedefs();
 
     // Add a few special ones to keep the system working
     g_typedef_map["ULong64_t"] = "unsigned long long";
@@ -111,6 +105,10 @@ void build_typedef_map() {
     g_typedef_map["xAOD::CaloCluster_v1::flt_t"] = "float";
 }
 
+void clear_typedef_cache() {
+    g_typedef_map.clear();
+}
+
 // Build a list of type mapping
 map<string, vector<string>> root_typedef_map()
 {
@@ -130,6 +128,7 @@ map<string, vector<string>> root_typedef_map()
 // From typedefs, return resolved typedefs.
 // Do not call until all libraries have been loaded!
 string resolve_typedef(const string &c_name) {
+    add_count(run_counter::typedef_resolutions);
     // Check the typedef name
     build_typedef_map();
     auto t = parse_typename(c_name);
@@ -156,9 +155,9 @@ string resolve_typedef(const string &c_name) {
     }
 
     // Last is to normalize, if possible, with a class name
-    auto c = get_tclass(result);
-    if (c != nullptr) {
-        result = c->GetName();
+    auto class_name = reflection().class_name(result);
+    if (class_name.size() > 0) {
+        result = class_name;
     }
 
     // Reapply the various modifiers
@@ -220,6 +219,7 @@ std::regex _multi_space_regex("\\s+");
 // class_name<t1,t2>::class_name2<t3, t4>::size_type
 typename_info parse_typename(const string &type_name)
 {
+    add_count(run_counter::parse_typename_calls);
     typename_info result;
     result.is_const = false;
     result.cpp_name = "";
@@ -449,13 +449,8 @@ bool is_collection(const typename_info &ti) {
 bool is_collection(const class_info &ci) {
     // Look to see if there is a begin/end method. If so, then we will
     // assume that is good to go!
-
-    try {
-        container_of(ci);
-        return true;
-    } catch (std::runtime_error &e) {
-        return false;
-    }
+    typename_info contained_type;
+    return try_container_of(ci, contained_type);
 }
 
 map<string, string> _g_container_iterator_specials = {
@@ -470,33 +465,61 @@ typename_info container_of(const typename_info &ti) {
 // Given this is a container, as above, figure out
 // what it is containing.
 typename_info container_of(const class_info &ci) {
+    typename_info contained_type;
+    string why;
+    if (!try_container_of(ci, contained_type, &why)) {
+        throw runtime_error(why);
+    }
+    return contained_type;
+}
+
+bool try_container_of(const class_info &ci, typename_info &contained_type, string *why) {
     // If this is a vector object, then we can grab from the argument
     if (ci.name_as_type.type_name == "vector") {
-        return ci.name_as_type.template_arguments[0];
+        contained_type = ci.name_as_type.template_arguments[0];
+        return true;
     }
     if (ci.name_as_type.type_name == "DataVector") {
-        return ci.name_as_type.template_arguments[0];
+        contained_type = ci.name_as_type.template_arguments[0];
+        return true;
     }
 
     // If there is a begin/end object, lets lift that out.
     if (has_methods(ci, {"begin", "end"})) {
-        auto rtn_type_name = get_method(ci, "begin")[0].return_type;
+        auto &&rtn_type_name = find_method(ci, "begin")->return_type;
 
 
         auto rtn_type = _g_container_iterator_specials.find(rtn_type_name);
         if (rtn_type != _g_container_iterator_specials.end()) {
-            return parse_typename(rtn_type->second);
+            contained_type = parse_typename(rtn_type->second);
+            return true;
         }
 
-        auto &&c = get_tclass(rtn_type_name);
-        if (c != nullptr) {
-            return parse_typename(c->GetName());
-        } else {
-            throw runtime_error("Unable to find container type for iterator type " + rtn_type_name + " for container " + ci.name);
+        auto c_name = reflection().class_name(rtn_type_name);
+        if (c_name.size() > 0) {
+            contained_type = parse_typename(c_name);
+            return true;
+        }
+        if (why != nullptr) {
+            *why = "Unable to find container type for iterator type " + rtn_type_name + " for container " + ci.name;
         }
+        return false;
     }
 
-    throw runtime_error("Do not know how to find container type for class " + ci.name);
+    if (why != nullptr) {
+        *why = "Do not know how to find container type for class " + ci.name;
+    }
+    return false;
+}
+
+// Work out, once per class, if it is a container.
+void classify_containers(vector<class_info> &classes)
+{
+    for (auto &&c : classes)
+    {
+        c.container_type = typename_info();
+        c.is_container = try_container_of(c, c.container_type);
+    }
 }
 
 // Return a list of the C++ types that this type refers to in its
@@ -599,22 +622,60 @@ bool is_understood_type(const typename_info &t, const set<std::string> &known_ty
     return false;
 }
 
+understood_type_cache::understood_type_cache(const set<string> &known_types)
+    : m_known_types(&known_types), m_version(0)
+{
+}
+
+void understood_type_cache::reset(const set<string> &known_types)
+{
+    m_known_types = &known_types;
+    m_version++;
+    m_verdicts.clear();
+}
+
+// Parse the type just once, and remember if it is in the known types.
+const understood_type_cache::verdict &understood_type_cache::lookup(const string &t_name)
+{
+    auto itr = m_verdicts.find(t_name);
+    if (itr != m_verdicts.end()) {
+        return itr->second;
+    }
+
+    verdict v;
+    v.unqualified_name = unqualified_typename(parse_typename(t_name));
+    v.understood = m_known_types->find(v.unqualified_name) != m_known_types->end();
+    return m_verdicts.emplace(t_name, v).first->second;
+}
+
+bool understood_type_cache::is_understood(const string &t_name)
+{
+    return lookup(t_name).understood;
+}
+
+const string &understood_type_cache::unqualified_name(const string &t_name)
+{
+    return lookup(t_name).unqualified_name;
+}
+
 // Can we emit this class?
 //  1. The method must return something (e.g. it can't be void)
 //  2. All types used in the method must be known.
 bool is_understood_method(const method_info &meth, const set<string> &classes_to_emit) {
+    understood_type_cache known_types(classes_to_emit);
+    return is_understood_method(meth, known_types);
+}
+
+bool is_understood_method(const method_info &meth, understood_type_cache &known_types) {
     // Make sure returns something.
     if (meth.return_type.size() == 0) {
         return false;
     }
 
-    // Get all referenced types, and make sure we know about those types.
-    auto method_types = referenced_types(meth);
-    set<string> method_types_set(method_types.begin(), method_types.end());
-
     // Next, look at the template arguments and see if they define any special
-    // types that we should "allow" for just this method.
-    set<string> known_classes(classes_to_emit);
+    // types that we should "allow" for just this method. These are checked on
+    // top of the known types, so the known types never need to be copied.
+    vector<string> method_known_types;
     for (auto &&t_arg : meth.parameter_arguments)
     {
         auto t_parsed = parse_typename(t_arg.full_typename);
@@ -623,14 +684,17 @@ bool is_understood_method(const method_info &meth, const set<string> &classes_to
                 throw runtime_error("Method " + meth.name + " uses a template argument of cpp_type and doesn't have exactly one template argument");
             }
             
-            known_classes.insert(t_parsed.template_arguments[0].cpp_name);
+            method_known_types.push_back(t_parsed.template_arguments[0].cpp_name);
         }
     }
-    
 
-    for (auto &&m_type: method_types_set) {
-        if (!is_understood_type(m_type, known_classes)) {
-            return false;
+    // Get all referenced types, and make sure we know about those types.
+    for (auto &&m_type: referenced_types(meth)) {
+        if (!known_types.is_understood(m_type)) {
+            auto &uq_name = known_types.unqualified_name(m_type);
+            if (find(method_known_types.begin(), method_known_types.end(), uq_name) == method_known_types.end()) {
+                return false;
+            }
         }
     }
     return true;
@@ -712,18 +776,80 @@ typename_info parent_class(const typename_info &ti)
     return result;
 }
 
-// Get a TClass pointer, but protect against fetching
-// internal classes.
-TClass *get_tclass(const string &name)
+// Some base types that aren't classes but are well known.
+set<string> _g_fundamental_types({
+    "int",
+    "float",
+    "double",
+    "bool",
+    "string",
+    "char",
+    "unsigned char",
+    "signed char",
+    "short",
+    "unsigned short",
+    "unsigned int",
+    "long",
+    "unsigned long",
+    "long long",
+    "unsigned long long",
+    "char16_t",
+    "char32_t",
+    "uint",
+    "uint8_t",
+    "uint16_t",
+    "uint32_t",
+    "uint64_t",
+    "int8_t",
+    "int16_t",
+    "int32_t",
+    "int64_t",
+});
+
+bool is_fundamental_type(const string &t_name)
 {
-    // Any type that looks like it has something internal,
-    // like __gnu_cxx::xxxx. ROOT has some issue with these,
-    // printing out error messages to cout (rather than cerr),
-    // which pollutes out output, of course. We don't need them,
-    // so avoid them.
-    if (name.find("__") != string::npos) {
-        return nullptr;
+    return _g_fundamental_types.find(t_name) != _g_fundamental_types.end();
+}
+
+// A type is in one of the namespaces if its outer most namespace is listed, or it is
+// one of the listed namespaces itself (e.g. "xAOD"). Types in the global namespace:
+//  - Templates are in if any of their arguments are in (so vector<xAOD::Jet_v1>
+//    is in if xAOD is), or they have only fundamental arguments.
+//  - Fundamental types are always in.
+//  - Everything else only if "::" is listed.
+bool type_in_namespaces(const typename_info &t, const set<string> &namespaces)
+{
+    if (t.namespace_list.size() > 0) {
+        auto outer = &t.namespace_list[0];
+        while (outer->namespace_list.size() > 0) {
+            outer = &outer->namespace_list[0];
+        }
+
+        // Something like DataVector<xAOD::Jet_v1>::iterator - the outer scope is a global template.
+        if (outer->template_arguments.size() > 0) {
+            return type_in_namespaces(*outer, namespaces);
+        }
+        return namespaces.find(outer->type_name) != namespaces.end();
     }
 
-    return TClass::GetClass(name.c_str());
-}
\ No newline at end of file
+    if (t.template_arguments.size() > 0) {
+        bool all_fundamental = true;
+        for (auto &&t_arg : t.template_arguments)
+        {
+            // Integer template arguments carry no namespace.
+            if (all_of(t_arg.type_name.begin(), t_arg.type_name.end(), [](char c) {return isdigit(c) || c == '-';})) {
+                continue;
+            }
+            if (t_arg.namespace_list.size() > 0 || t_arg.template_arguments.size() > 0 || !is_fundamental_type(t_arg.type_name)) {
+                all_fundamental = false;
+                if (type_in_namespaces(t_arg, namespaces)) {
+                    return true;
+                }
+            }
+        }
+        return all_fundamental || namespaces.find("::") != namespaces.end();
+    }
+
+    return is_fundamental_type(t.type_name) || namespaces.find(t.type_name) != namespaces.end()
+        || namespaces.find("::") != namespaces.end();
+}
@@ -6,7 +6,6 @@
 #include <map>
 #include <algorithm>
 
-#include "TClass.h"
 
 using namespace std;
 
@@ -42,7 +41,7 @@ string get_prefix_name(const class_info &c, const string &prefix) {
 
 
 // Extract a collection from the info.
-collection_info get_collection_info(const class_info &c, const vector<class_info> &all_classes) {
+collection_info get_collection_info(const class_info &c, const map<string, const class_info*> &all_classes) {
     collection_info r;
 
     // Find the name that ends in collection - we'll use that
@@ -69,12 +68,11 @@ collection_info get_collection_info(const class_info &c, const vector<class_info
     r.include_file = c.include_file;
 
     // The library is just the prefix on the include for the cpp item
-    auto cls_ptr = find_if(all_classes.begin(), all_classes.end(),
-        [item](const class_info &a_class_item){return a_class_item.name == item.cpp_name;});
+    auto cls_ptr = all_classes.find(item.cpp_name);
     if (cls_ptr == all_classes.end()) {
         throw runtime_error("Cannot find class " + item.cpp_name + " in ROOT's class list when trying to create collection " + c.name + ".");
     }
-    r.link_libraries.push_back(cls_ptr->library_name);
+    r.link_libraries.push_back(cls_ptr->second->library_name);
 
 
     // And parse the iterator
@@ -103,16 +101,24 @@ vector<collection_info> find_collections(const vector<class_info> &all_classes)
 {
     vector<collection_info> result;
 
+    // Index the classes by name (first one wins) so we don't have to search
+    // the full list for each collection.
+    map<string, const class_info*> classes_by_name;
+    for (auto &&c : all_classes)
+    {
+        classes_by_name.emplace(c.name, &c);
+    }
+
     // From the list of all classes, generate the collections for those
     // that inherit correctly.
     set<string> seen_collections;
     for (auto &&c : all_classes)
     {
         if (is_xaod_collection_class(c)) {
-            auto c_info = get_collection_info(c, all_classes);
+            auto c_info = get_collection_info(c, classes_by_name);
             if (seen_collections.find(c_info.name) == seen_collections.end()) {
-                result.push_back(c_info);
                 seen_collections.insert(c_info.name);
+                result.push_back(move(c_info));
             }
         }
     }
@@ -130,7 +136,7 @@ vector<collection_info> get_single_object_collections(const vector<class_info> &
     // turn those into collections here.
     for (auto &&c : g_single_collection_names) {
         auto resolved_name = resolve_typedef(c.second);
-        auto found_class = find_if(all_classes.begin(), all_classes.end(), [resolved_name](const class_info &cls){return cls.name == resolved_name;});
+        auto found_class = find_if(all_classes.begin(), all_classes.end(), [&resolved_name](const class_info &cls){return cls.name == resolved_name;});
         if (found_class != all_classes.end()) {
             collection_info ci;
             ci.name = c.first;
@@ -138,7 +144,7 @@ vector<collection_info> get_single_object_collections(const vector<class_info> &
             ci.iterator_type_info = parse_typename(resolved_name);
             ci.include_file = found_class->include_file;
             ci.link_libraries.push_back(found_class->library_name);
-            result.push_back(ci);
+            result.push_back(move(ci));
         }
     }
 
@@ -0,0 +1,330 @@
+#include "yaml_spec_writer.hpp"
+#include "helper_files.hpp"
+
+#include <fstream>
+
+using namespace std;
+
+namespace {
+    // Given a list of arguments, dump them out.
+    void dump_arguments(const string &arg_list_name, const vector<spec_argument> &arguments, YAML::Emitter &out) {
+        bool first_argument = true;
+        for (auto &&arg : arguments)
+        {
+            if (first_argument) {
+                first_argument = false;
+                out << YAML::Key << arg_list_name
+                    << YAML::Value
+                    << YAML::BeginSeq;
+            }
+            out << YAML::BeginMap
+                << YAML::Key << "name" << YAML::Value << arg.name
+                << YAML::Key << "type" << YAML::Value << arg.type
+                << YAML::EndMap;
+        }
+        if (!first_argument) {
+            out << YAML::EndSeq;
+        }
+    }
+}
+
+// The emitter writes to the stream as we go.
+yaml_spec_writer::yaml_spec_writer(ostream &out)
+    : m_stream(out), m_out(out), m_files_header_written(false)
+{
+    m_out << YAML::BeginMap;
+}
+
+void yaml_spec_writer::write_collections(const vector<spec_collection> &collections)
+{
+    auto &&out = m_out;
+    out << YAML::Key << "collections"
+        << YAML::Value
+        << YAML::BeginSeq;
+    for (auto &&c : collections)
+    {
+        out << YAML::BeginMap
+            << YAML::Key << "collection_name" << YAML::Value << c.collection_name
+            << YAML::Key << "cpp_item_type" << YAML::Value << c.cpp_item_type
+            << YAML::Key << "python_item_type" << YAML::Value << c.python_item_type
+            << YAML::Key << "cpp_container_type" << YAML::Value << c.cpp_container_type
+            << YAML::Key << "python_container_type" << YAML::Value << c.python_container_type
+            << YAML::Key << "include_file" << YAML::Value << c.include_file
+            << YAML::Key << "link_libraries" << YAML::Value << YAML::BeginSeq;
+
+        for (auto &&lib : c.link_libraries)
+        {
+            out << lib;
+        }
+        out << YAML::EndSeq;
+
+        if (c.has_metadata) {
+            auto &&meta_data = c.metadata;
+
+            if (meta_data.method_callback.size() > 0) {
+                out << YAML::Key << "method_callback" << meta_data.method_callback;
+            }
+
+            if (meta_data.parameters.size() > 0) {
+                out << YAML::Key << "parameters" << YAML::Value;
+                out << YAML::BeginSeq;
+                for (auto &&p : meta_data.parameters)
+                {
+                    out << YAML::BeginMap;
+                    out << YAML::Key << "name" << YAML::Value << p.name;
+                    out << YAML::Key << "type" << YAML::Value << p.p_type;
+                    out << YAML::Key << "default_value" << YAML::Value << p.p_default;
+                    out << YAML::EndMap;
+                }                
+                out << YAML::EndSeq;
+            }
+
+            if (meta_data.extra_parameters.size() > 0) {
+                out << YAML::Key << "extra_parameters" << YAML::Value;
+                out << YAML::BeginSeq;
+                for (auto &&p : meta_data.extra_parameters)
+                {
+                    out << YAML::BeginMap;
+                    out << YAML::Key << "name" << YAML::Value << p.name;
+                    out << YAML::Key << "type" << YAML::Value << p.p_type;
+                    out << YAML::Key << "default_value" << YAML::Value << p.p_default;
+                    out << YAML::Key << "actions" << YAML::BeginSeq;
+
+                    for (auto && a: p.variable_actions) {
+                        out << YAML::BeginMap;
+                        out << YAML::Key << "value" << YAML::Value << a.value;
+                        out << YAML::Key << "metadata_names" << YAML::Value << YAML::BeginSeq;
+                        for (auto &&md : a.metadata_names) {
+                            out << md;
+                        }
+                        out << YAML::EndSeq;
+                        out << YAML::Key << "bank_rename" << YAML::Value << a.bank_rename;
+                        out << YAML::EndMap;
+                    }
+
+                    out << YAML::EndSeq;
+                    out << YAML::EndMap;
+
+                }
+                
+                out << YAML::EndSeq;
+            }
+        } else {
+            // Write out the default name parameter for collections that have no actions associated
+            // with them.
+            out << YAML::Key << "parameters" << YAML::Value;
+            out << YAML::BeginSeq;
+
+            out << YAML::BeginMap;
+            out << YAML::Key << "name" << YAML::Value << "name";
+            out << YAML::Key << "type" << YAML::Value << "str";
+            out << YAML::EndMap;
+
+            out << YAML::EndSeq;
+        }
+
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+}
+
+void yaml_spec_writer::begin_classes()
+{
+    m_out << YAML::Key << "classes"
+        << YAML::Value
+        << YAML::BeginSeq;
+}
+
+void yaml_spec_writer::write_class(const spec_class &c)
+{
+    auto &&out = m_out;
+    out << YAML::BeginMap
+        << YAML::Key << "python_name" << YAML::Value << c.python_name
+        << YAML::Key << "cpp_name" << YAML::Value << c.cpp_name;
+    
+    if (c.library.size() > 0) {
+        out << YAML::Key << "library" << YAML::Value << c.library;
+    }
+
+    if (c.is_container) {
+        out << YAML::Key << "is_container_of_cpp" << YAML::Value << c.is_container_of_cpp;
+        out << YAML::Key << "is_container_of_python" << YAML::Value << c.is_container_of_python;
+    }
+    
+    if (c.include_file.size() > 0) {
+        out << YAML::Key << "include_file" << YAML::Value << c.include_file;
+    }
+
+    if (c.also_behaves_like.size() > 0) {
+        out << YAML::Key << "also_behaves_like" << YAML::Value << YAML::BeginSeq;
+        for(auto &&b : c.also_behaves_like) {
+            out << b;
+        }
+        out << YAML::EndSeq;
+    }
+
+    if (c.inherits_from.size() > 0) {
+        out << YAML::Key << "inherits_from" << YAML::Value << YAML::BeginSeq;
+        for(auto &&b : c.inherits_from) {
+            out << b;
+        }
+        out << YAML::EndSeq;
+    }
+
+    // Now we need to emit the enums.
+    if (c.enums.size() > 0)
+    {
+        out << YAML::Key << "enums"
+            << YAML::Value
+            << YAML::BeginSeq;
+        for (auto &&e : c.enums)
+        {
+            out << YAML::BeginMap
+                << YAML::Key << "name" << YAML::Value << e.name
+                << YAML::Key << "values" << YAML::Value
+                << YAML::BeginSeq;
+            for (auto &&v : e.values)
+            {
+                out << YAML::BeginMap
+                    << YAML::Key << "name" << YAML::Value << v.first
+                    << YAML::Key << "value" << YAML::Value << v.second
+                    << YAML::EndMap;
+            }
+            out << YAML::EndSeq
+                << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+    }
+
+    // Now we need to emit the methods.
+    if (c.methods.size() > 0) {
+        out << YAML::Key << "methods"
+            << YAML::Value
+            << YAML::BeginSeq;
+        for (auto &&meth : c.methods)
+        {
+            out << YAML::BeginMap
+                << YAML::Key << "name" << YAML::Value << meth.name
+                << YAML::Key << "return_type" << YAML::Value << meth.return_type;
+
+            dump_arguments("arguments", meth.arguments, out);
+            dump_arguments("parameter_arguments", meth.parameter_arguments, out);
+
+            if (meth.param_helper.size() > 0) {
+                out << YAML::Key << "param_helper" << YAML::Value << meth.param_helper;
+            }
+
+            if (meth.param_type_callback.size() > 0) {
+                out << YAML::Key << "param_type_callback" << YAML::Value << meth.param_type_callback;
+            }
+
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
+    }
+
+    out << YAML::EndMap;
+}
+
+void yaml_spec_writer::end_classes()
+{
+    m_out << YAML::EndSeq;
+}
+
+// The files header is only written if there is at least one file.
+void yaml_spec_writer::begin_files()
+{
+    m_files_header_written = false;
+}
+
+void yaml_spec_writer::write_file(const spec_file &f)
+{
+    auto &&out = m_out;
+    if (!m_files_header_written) {
+        m_files_header_written = true;
+        out << YAML::Key << "files" << YAML::Value << YAML::BeginSeq;
+    }
+
+    out << YAML::BeginMap;
+
+    // Header info
+    out << YAML::Key << "name" << YAML::Value << f.name;
+    out << YAML::Key << "init_lines" << YAML::Value << YAML::BeginSeq;
+    for (auto &&line : f.init_lines) {
+        out << line;
+    }
+    out << YAML::EndSeq;
+
+    // Now file contents
+    if (f.reference.size() > 0) {
+        out << YAML::Key << "content_hash" << YAML::Value << f.content_hash;
+        out << YAML::Key << "reference" << YAML::Value << f.reference;
+    } else if (f.as_text) {
+        out << YAML::Key << "content_hash" << YAML::Value << f.content_hash;
+        out << YAML::Key << "text" << YAML::Value << YAML::Literal << helper_file_text(f.contents);
+    } else {
+        out << YAML::Key << "contents" << YAML::Value << YAML::BeginSeq;
+        out.SetStringFormat(YAML::DoubleQuoted);
+        for (auto &&line : f.contents) {
+            out << line;
+        }
+        out << YAML::EndSeq;
+    }
+
+    out << YAML::EndMap;
+}
+
+void yaml_spec_writer::end_files()
+{
+    if (m_files_header_written) {
+        m_out << YAML::EndSeq;
+    }
+}
+
+void yaml_spec_writer::write_config(const spec_config &config)
+{
+    auto &&out = m_out;
+    out << YAML::Key << "config";
+    out << YAML::BeginMap;
+
+    out << YAML::Key << "atlas_release" << YAML::Value << config.atlas_release;
+    out << YAML::Key << "dataset_types" << YAML::Value;
+    out << YAML::BeginSeq;
+    for (auto &&dt : config.dataset_types) {
+        out << dt;
+    }
+    out << YAML::EndSeq;
+
+    if (config.declared_methods_only) {
+        out << YAML::Key << "declared_methods_only" << YAML::Value << true;
+    }
+    if (config.content_hash.size() > 0) {
+        out << YAML::Key << "content_hash" << YAML::Value << config.content_hash;
+    }
+    if (config.inputs_hash.size() > 0) {
+        out << YAML::Key << "inputs_hash" << YAML::Value << config.inputs_hash;
+    }
+
+    out << YAML::EndMap;
+}
+
+void yaml_spec_writer::finish(const string &extra_metadata_path)
+{
+    m_out << YAML::EndMap;
+    m_stream << endl;
+
+    // Next, append the metadata file onto the end of this
+    append_file(m_stream, extra_metadata_path);
+}
+
+// Copy a file, a buffer at a time.
+void append_file(ostream &out, const string &path)
+{
+    fstream metadata_in(path);
+    const int buf_size = 4096;
+    char buf[buf_size];
+    do {
+        metadata_in.read(&buf[0], buf_size);
+        out.write(&buf[0], metadata_in.gcount());
+    } while (metadata_in.gcount() > 0);     
+}
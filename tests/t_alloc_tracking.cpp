@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include "alloc_tracking.hpp"
+#include "phase_timer.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+TEST(t_alloc_tracking, counts_allocations) {
+    auto start = read_alloc_totals();
+    {
+        auto p = make_unique<vector<int>>(1000);
+    }
+    auto diff = read_alloc_totals() - start;
+
+    if (allocations_tracked()) {
+        EXPECT_GE(diff.allocations, 2);
+        EXPECT_GE(diff.frees, 2);
+        EXPECT_GE(diff.bytes_allocated, 1000 * sizeof(int));
+    } else {
+        EXPECT_EQ(diff.allocations, 0);
+        EXPECT_EQ(diff.bytes_allocated, 0);
+    }
+}
+
+TEST(t_alloc_tracking, per_phase) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "allocate");
+        vector<unique_ptr<int>> v;
+        for (int i = 0; i < 100; i++) {
+            v.push_back(make_unique<int>(i));
+        }
+    }
+    {
+        scoped_phase p(timer, "nothing");
+    }
+
+    ASSERT_EQ(timer.phases().size(), 2);
+    if (allocations_tracked()) {
+        EXPECT_GE(timer.phases()[0].allocations, 100);
+        EXPECT_GE(timer.phases()[0].bytes_allocated, 100 * sizeof(int));
+        EXPECT_LT(timer.phases()[1].allocations, 10);
+    } else {
+        EXPECT_EQ(timer.phases()[0].allocations, 0);
+    }
+}
+
+TEST(t_alloc_tracking, peak_per_phase) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "big");
+        auto big = make_unique<vector<char>>(8 * 1024 * 1024);
+        {
+            scoped_phase inner(timer, "small");
+            auto small = make_unique<vector<char>>(1024);
+        }
+    }
+    {
+        scoped_phase p(timer, "after");
+        auto small = make_unique<vector<char>>(1024);
+    }
+
+    ASSERT_EQ(timer.phases().size(), 3);
+    auto &small = timer.phases()[0];
+    auto &big = timer.phases()[1];
+    auto &after = timer.phases()[2];
+    if (allocations_tracked()) {
+        // The inner phase starts with the big block live, but the phase after does not
+        EXPECT_GE(big.peak_live_bytes, 8 * 1024 * 1024);
+        EXPECT_GE(small.peak_live_bytes, 8 * 1024 * 1024);
+        EXPECT_LT(after.peak_live_bytes, big.peak_live_bytes - 4 * 1024 * 1024);
+        EXPECT_GE(timer.total().peak_live_bytes, big.peak_live_bytes);
+    } else {
+        EXPECT_EQ(big.peak_live_bytes, 0);
+        EXPECT_EQ(after.peak_live_bytes, 0);
+    }
+}
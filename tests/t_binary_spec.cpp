@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "binary_spec_writer.hpp"
+#include "binary_spec_reader.hpp"
+#include "yaml_spec_writer.hpp"
+
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    vector<spec_class> test_classes() {
+        vector<spec_class> result;
+
+        spec_class c;
+        c.python_name = "xAOD.Jet_v1";
+        c.cpp_name = "xAOD::Jet_v1";
+        c.library = "xAODJet";
+        c.is_container = false;
+        c.include_file = "xAODJet/versions/Jet_v1.h";
+        c.also_behaves_like = {"xAOD.IParticle"};
+        c.inherits_from = {"xAOD::IParticle"};
+        c.enums.push_back(enum_info{"Color", {{"red", 0}, {"green", -1}}});
+
+        spec_method m;
+        m.name = "getAttribute";
+        m.return_type = "U";
+        m.arguments.push_back(spec_argument{"name", "std::string"});
+        m.parameter_arguments.push_back(spec_argument{"U", "cpp_type[U]"});
+        m.param_helper = "func_adl_servicex_xaodr22.type_support.index_type_forwarder";
+        c.methods.push_back(m);
+
+        spec_method pt;
+        pt.name = "pt";
+        pt.return_type = "double";
+        c.methods.push_back(pt);
+        result.push_back(c);
+
+        spec_class vc;
+        vc.python_name = "vector[float]";
+        vc.cpp_name = "vector<float>";
+        vc.is_container = true;
+        vc.is_container_of_cpp = "float";
+        vc.is_container_of_python = "float";
+        result.push_back(vc);
+
+        spec_class a;
+        a.python_name = "xAOD.Electron_v1";
+        a.cpp_name = "xAOD::Electron_v1";
+        a.is_container = false;
+        a.methods.push_back(pt);
+        result.push_back(a);
+
+        return result;
+    }
+
+    // Write the classes out as yaml
+    string as_yaml(const vector<spec_class> &classes) {
+        ostringstream out;
+        yaml_spec_writer writer(out);
+        writer.begin_classes();
+        for (auto &&c : classes) {
+            writer.write_class(c);
+        }
+        writer.end_classes();
+        writer.write_config(spec_config{"22.2.107", {"PHYS", "PHYSLITE"}});
+        writer.finish("no_such_file.yaml");
+        return out.str();
+    }
+
+    void write_binary(const string &path, const vector<spec_class> &classes) {
+        ofstream out(path, ios::binary);
+        binary_spec_writer writer(out);
+        writer.write_collections({});
+        writer.begin_classes();
+        for (auto &&c : classes) {
+            writer.write_class(c);
+        }
+        writer.end_classes();
+        writer.write_config(spec_config{"22.2.107", {"PHYS", "PHYSLITE"}});
+        writer.finish("no_such_file.yaml");
+    }
+}
+
+TEST(t_binary_spec, round_trip_matches_yaml)
+{
+    auto classes = test_classes();
+    write_binary("t_binary_spec_round_trip.bin", classes);
+
+    binary_spec_reader reader("t_binary_spec_round_trip.bin");
+    vector<spec_class> read_back;
+    for (auto &&c : reader.classes()) {
+        read_back.push_back(reader.read_class(c));
+    }
+
+    EXPECT_EQ(as_yaml(read_back), as_yaml(classes));
+    EXPECT_EQ(reader.atlas_release(), "22.2.107");
+    EXPECT_FALSE(reader.declared_methods_only());
+}
+
+TEST(t_binary_spec, find_class_by_name)
+{
+    write_binary("t_binary_spec_find.bin", test_classes());
+    binary_spec_reader reader("t_binary_spec_find.bin");
+
+    for (auto &&name : {"xAOD::Jet_v1", "vector<float>", "xAOD::Electron_v1"}) {
+        auto c = reader.find_class(name);
+        ASSERT_NE(c, nullptr) << name;
+        EXPECT_EQ(reader.string_at(c->cpp_name), name);
+    }
+    EXPECT_EQ(reader.find_class("xAOD::Muon_v1"), nullptr);
+    EXPECT_EQ(reader.find_class(""), nullptr);
+}
+
+TEST(t_binary_spec, methods_of_class)
+{
+    write_binary("t_binary_spec_methods.bin", test_classes());
+    binary_spec_reader reader("t_binary_spec_methods.bin");
+
+    auto c = reader.find_class("xAOD::Jet_v1");
+    ASSERT_NE(c, nullptr);
+    auto methods = reader.methods(*c);
+    ASSERT_EQ(methods.size(), 2);
+    EXPECT_EQ(reader.string_at(methods[0].name), "getAttribute");
+    EXPECT_EQ(reader.string_at(methods[1].name), "pt");
+    ASSERT_EQ(reader.arguments(methods[0]).size(), 1);
+    EXPECT_EQ(reader.string_at(reader.arguments(methods[0])[0].type), "std::string");
+    EXPECT_EQ(reader.string_at(methods[1].param_helper), "");
+}
+
+TEST(t_binary_spec, empty_spec)
+{
+    write_binary("t_binary_spec_empty.bin", {});
+    binary_spec_reader reader("t_binary_spec_empty.bin");
+
+    EXPECT_EQ(reader.classes().size(), 0);
+    EXPECT_EQ(reader.find_class("xAOD::Jet_v1"), nullptr);
+}
+
+TEST(t_binary_spec, not_a_binary_spec)
+{
+    {
+        ofstream out("t_binary_spec_bad.bin");
+        out << "collections: []" << endl;
+        for (int i = 0; i < 20; i++) {
+            out << "# padding out past the size of the header" << endl;
+        }
+    }
+    EXPECT_THROW(binary_spec_reader("t_binary_spec_bad.bin"), runtime_error);
+    EXPECT_THROW(binary_spec_reader("t_binary_spec_no_such_file.bin"), runtime_error);
+}
+
+TEST(t_binary_spec, truncated_file)
+{
+    write_binary("t_binary_spec_full.bin", test_classes());
+    string contents;
+    {
+        ifstream in("t_binary_spec_full.bin", ios::binary);
+        contents.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    {
+        ofstream out("t_binary_spec_truncated.bin", ios::binary);
+        out.write(contents.data(), contents.size() - 10);
+    }
+    EXPECT_THROW(binary_spec_reader("t_binary_spec_truncated.bin"), runtime_error);
+}
@@ -189,3 +189,39 @@ TEST(t_class_info, get_methods_yes) {
     EXPECT_EQ(a.size(), 1);
     EXPECT_EQ(a[0].name, "end");
 }
+
+TEST(t_class_info, nearest_emitted_ancestors_direct) {
+    class_info particle;
+    particle.name = "xAOD::IParticle";
+    particle.inherited_class_names = {"SG::AuxElement"};
+    class_info aux;
+    aux.name = "SG::AuxElement";
+    class_info jet;
+    jet.name = "xAOD::Jet_v1";
+    jet.inherited_class_names = {"xAOD::IParticle"};
+
+    map<string, const class_info*> classes {{particle.name, &particle}, {aux.name, &aux}, {jet.name, &jet}};
+    set<string> all_emitted;
+    auto nearest = nearest_emitted_ancestors(jet, classes, {"xAOD::IParticle", "SG::AuxElement", "xAOD::Jet_v1"}, all_emitted);
+
+    EXPECT_EQ(nearest, vector<string>{"xAOD::IParticle"});
+    EXPECT_EQ(all_emitted, (set<string>{"xAOD::IParticle", "SG::AuxElement"}));
+}
+
+TEST(t_class_info, nearest_emitted_ancestors_skip_not_emitted) {
+    class_info particle;
+    particle.name = "xAOD::IParticle";
+    particle.inherited_class_names = {"SG::AuxElement"};
+    class_info aux;
+    aux.name = "SG::AuxElement";
+    class_info jet;
+    jet.name = "xAOD::Jet_v1";
+    jet.inherited_class_names = {"xAOD::IParticle", "Unknown"};
+
+    map<string, const class_info*> classes {{particle.name, &particle}, {aux.name, &aux}, {jet.name, &jet}};
+    set<string> all_emitted;
+    auto nearest = nearest_emitted_ancestors(jet, classes, {"SG::AuxElement", "xAOD::Jet_v1"}, all_emitted);
+
+    EXPECT_EQ(nearest, vector<string>{"SG::AuxElement"});
+    EXPECT_EQ(all_emitted, set<string>{"SG::AuxElement"});
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "compressing_streambuf.hpp"
+
+#include <zlib.h>
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    // Decompress a gzip file that may have several members
+    string gunzip(const string &input) {
+        z_stream zs = {};
+        EXPECT_EQ(inflateInit2(&zs, 15 + 32), Z_OK);
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        zs.avail_in = static_cast<uInt>(input.size());
+
+        string output;
+        char buf[4096];
+        while (true) {
+            zs.next_out = reinterpret_cast<Bytef*>(buf);
+            zs.avail_out = sizeof(buf);
+            auto status = inflate(&zs, Z_NO_FLUSH);
+            output.append(buf, sizeof(buf) - zs.avail_out);
+            if (status == Z_STREAM_END) {
+                if (zs.avail_in == 0) {
+                    break;
+                }
+                inflateReset(&zs);
+            } else if (status != Z_OK) {
+                ADD_FAILURE() << "inflate failed with " << status;
+                break;
+            }
+        }
+        inflateEnd(&zs);
+        return output;
+    }
+
+    string test_text(int lines) {
+        ostringstream text;
+        for (int i = 0; i < lines; i++) {
+            text << "  - name: method_" << i << endl << "    return_type: double" << endl;
+        }
+        return text.str();
+    }
+}
+
+TEST(t_compressing_streambuf, gzip_round_trip)
+{
+    auto text = test_text(1000);
+
+    ostringstream out;
+    {
+        compressing_ostream c_out(out, spec_compression::gzip);
+        c_out << text;
+        c_out.finish();
+        EXPECT_EQ(c_out.compressor().bytes_in(), text.size());
+        EXPECT_EQ(c_out.compressor().bytes_out(), out.str().size());
+    }
+
+    EXPECT_LT(out.str().size(), text.size());
+    EXPECT_EQ(gunzip(out.str()), text);
+}
+
+TEST(t_compressing_streambuf, many_chunks_stay_in_order)
+{
+    auto text = test_text(5000);
+
+    ostringstream out;
+    {
+        compressing_streambuf buf(out, spec_compression::gzip, 3, 1000);
+        ostream c_out(&buf);
+        // Write in odd sized pieces so chunks don't line up with the writes
+        for (size_t i = 0; i < text.size(); i += 777) {
+            c_out << text.substr(i, 777);
+        }
+        buf.finish();
+    }
+
+    EXPECT_EQ(gunzip(out.str()), text);
+}
+
+TEST(t_compressing_streambuf, finish_from_destructor)
+{
+    ostringstream out;
+    {
+        compressing_ostream c_out(out, spec_compression::gzip, 2);
+        c_out << "hi there" << endl;
+    }
+    EXPECT_EQ(gunzip(out.str()), "hi there\n");
+}
+
+TEST(t_compressing_streambuf, empty_is_valid)
+{
+    ostringstream out;
+    {
+        compressing_ostream c_out(out, spec_compression::gzip);
+    }
+    EXPECT_GT(out.str().size(), 0);
+    EXPECT_EQ(gunzip(out.str()), "");
+}
+
+TEST(t_compressing_streambuf, none_passes_through)
+{
+    ostringstream out;
+    {
+        compressing_ostream c_out(out, spec_compression::none);
+        c_out << "hi there";
+    }
+    EXPECT_EQ(out.str(), "hi there");
+}
+
+TEST(t_compressing_streambuf, zstd_availability)
+{
+    if (compression_available(spec_compression::zstd)) {
+        ostringstream out;
+        compressing_ostream c_out(out, spec_compression::zstd);
+        c_out << test_text(100);
+        c_out.finish();
+        EXPECT_LT(out.str().size(), test_text(100).size());
+    } else {
+        ostringstream out;
+        EXPECT_THROW(compressing_streambuf(out, spec_compression::zstd), runtime_error);
+    }
+}
+
+TEST(t_compressing_streambuf, single_characters)
+{
+    auto text = test_text(3000);
+
+    ostringstream out;
+    {
+        compressing_streambuf buf(out, spec_compression::gzip, 2, 5000);
+        ostream c_out(&buf);
+        for (auto c : text) {
+            c_out.put(c);
+        }
+        buf.finish();
+        EXPECT_EQ(buf.bytes_in(), text.size());
+    }
+
+    EXPECT_EQ(gunzip(out.str()), text);
+}
+
+TEST(t_compressing_streambuf, shared_thread_limit)
+{
+    auto text = test_text(2000);
+    auto limit = make_shared<compression_thread_limit>(1);
+
+    ostringstream out1, out2, out3;
+    {
+        compressing_streambuf buf1(out1, spec_compression::gzip, limit, 1000);
+        compressing_streambuf buf2(out2, spec_compression::gzip, limit, 1000);
+        compressing_streambuf buf3(out3, spec_compression::gzip, limit, 1000);
+        ostream c_out1(&buf1), c_out2(&buf2), c_out3(&buf3);
+        for (size_t i = 0; i < text.size(); i += 500) {
+            c_out1 << text.substr(i, 500) << flush;
+            c_out2 << text.substr(i, 500) << flush;
+            c_out3 << text.substr(i, 500) << flush;
+        }
+    }
+
+    EXPECT_EQ(limit->threads(), 1);
+    EXPECT_EQ(gunzip(out1.str()), text);
+    EXPECT_EQ(gunzip(out2.str()), text);
+    EXPECT_EQ(gunzip(out3.str()), text);
+}
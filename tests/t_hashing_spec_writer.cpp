@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "hashing_spec_writer.hpp"
+#include "yaml_spec_writer.hpp"
+#include "json_spec_writer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    spec_class simple_class(const string &method_name) {
+        spec_class c;
+        c.python_name = "xAOD.Jet_v1";
+        c.cpp_name = "xAOD::Jet_v1";
+        c.is_container = false;
+        spec_method m;
+        m.name = method_name;
+        m.return_type = "double";
+        c.methods.push_back(m);
+        return c;
+    }
+
+    // Write a spec, and return the config block from it
+    YAML::Node written_config(spec_writer &out, const string &method_name, ostringstream &text) {
+        hashing_spec_writer writer(out, "no_such_file.yaml");
+        writer.write_collections({});
+        writer.begin_classes();
+        writer.write_class(simple_class(method_name));
+        writer.end_classes();
+        writer.begin_files();
+        writer.end_files();
+        spec_config config{"22.2.107", {"PHYS"}};
+        config.inputs_hash = "1234";
+        writer.write_config(config);
+        writer.finish("no_such_file.yaml");
+        return YAML::Load(text.str())["config"];
+    }
+}
+
+TEST(t_hashing_spec_writer, fnv1a_known_values)
+{
+    fnv1a_hash empty;
+    EXPECT_EQ(empty.hex(), "cbf29ce484222325");
+
+    fnv1a_hash a;
+    a.add_bytes("a", 1);
+    EXPECT_EQ(a.hex(), "af63dc4c8601ec8c");
+}
+
+TEST(t_hashing_spec_writer, strings_are_length_prefixed)
+{
+    fnv1a_hash h1;
+    h1.add(string("ab"));
+    h1.add(string("c"));
+
+    fnv1a_hash h2;
+    h2.add(string("a"));
+    h2.add(string("bc"));
+
+    EXPECT_NE(h1.value(), h2.value());
+}
+
+TEST(t_hashing_spec_writer, hash_in_config)
+{
+    ostringstream text;
+    yaml_spec_writer y_writer(text);
+    auto config = written_config(y_writer, "pt", text);
+
+    EXPECT_EQ(config["content_hash"].as<string>().size(), 16);
+    EXPECT_EQ(config["inputs_hash"].as<string>(), "1234");
+}
+
+TEST(t_hashing_spec_writer, same_for_all_formats)
+{
+    ostringstream y_text, j_text;
+    yaml_spec_writer y_writer(y_text);
+    json_spec_writer j_writer(j_text);
+
+    EXPECT_EQ(written_config(y_writer, "pt", y_text)["content_hash"].as<string>(),
+        written_config(j_writer, "pt", j_text)["content_hash"].as<string>());
+}
+
+TEST(t_hashing_spec_writer, changes_with_content)
+{
+    ostringstream text1, text2;
+    yaml_spec_writer writer1(text1);
+    yaml_spec_writer writer2(text2);
+
+    EXPECT_NE(written_config(writer1, "pt", text1)["content_hash"].as<string>(),
+        written_config(writer2, "eta", text2)["content_hash"].as<string>());
+}
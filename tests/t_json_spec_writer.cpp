@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "json_spec_writer.hpp"
+#include "yaml_spec_writer.hpp"
+#include "helper_files.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    // A spec with a bit of everything in it
+    void write_test_spec(spec_writer &writer, const string &extra_metadata) {
+        spec_collection jets;
+        jets.collection_name = "Jets";
+        jets.cpp_item_type = "xAOD::Jet_v1";
+        jets.python_item_type = "xAOD.Jet_v1";
+        jets.cpp_container_type = "DataVector<xAOD::Jet_v1>";
+        jets.python_container_type = "Iterable[xAOD.Jet_v1]";
+        jets.include_file = "xAODJet/JetContainer.h";
+        jets.link_libraries = {"xAODJet"};
+        jets.has_metadata = true;
+        jets.metadata = _g_collection_config["Jets"];
+
+        spec_collection tracks(jets);
+        tracks.collection_name = "TrackParticles";
+        tracks.has_metadata = false;
+
+        writer.write_collections({jets, tracks});
+
+        spec_class c;
+        c.python_name = "xAOD.Jet_v1";
+        c.cpp_name = "xAOD::Jet_v1";
+        c.library = "xAODJet";
+        c.is_container = false;
+        c.include_file = "xAODJet/versions/Jet_v1.h";
+        c.also_behaves_like = {"xAOD.IParticle"};
+        c.inherits_from = {"xAOD::IParticle"};
+        c.enums.push_back(enum_info{"Color", {{"red", 0}, {"green", -1}}});
+
+        spec_method m;
+        m.name = "getAttribute";
+        m.return_type = "U";
+        m.arguments.push_back(spec_argument{"name", "std::string"});
+        m.parameter_arguments.push_back(spec_argument{"U", "cpp_type[U]"});
+        m.param_helper = "func_adl_servicex_xaodr22.type_support.index_type_forwarder";
+        m.param_type_callback = "lambda s, a: \"quoted\\\\ \\t tab\"";
+        c.methods.push_back(m);
+
+        spec_class vc;
+        vc.python_name = "vector[float]";
+        vc.cpp_name = "vector<float>";
+        vc.is_container = true;
+        vc.is_container_of_cpp = "float";
+        vc.is_container_of_python = "float";
+
+        writer.begin_classes();
+        writer.write_class(c);
+        writer.write_class(vc);
+        writer.end_classes();
+
+        writer.begin_files();
+        writer.write_file(spec_file{"trigger.py", {"from .trigger import tdt_chain_fired"}, {"import os", "x = \"a: b\"  # \x01"}});
+        spec_file text_file{"jets.py", {}, {"def f():", "    return 'a: b'", "", "x = 1"}};
+        text_file.as_text = true;
+        text_file.content_hash = helper_file_hash(text_file.contents);
+        writer.write_file(text_file);
+        auto ref_file = text_file;
+        ref_file.name = "muons.py";
+        ref_file.reference = "base.yaml";
+        writer.write_file(ref_file);
+        writer.end_files();
+
+        writer.write_config(spec_config{"22.2.107", {"PHYS", "PHYSLITE"}, true});
+        writer.finish(extra_metadata);
+    }
+
+    // What a reader using the core schema decodes a scalar as. Quoted scalars are
+    // always strings.
+    string scalar_kind(const YAML::Node &n) {
+        if (n.Tag() == "!") {
+            return "string";
+        }
+        bool b;
+        if (YAML::convert<bool>::decode(n, b)) {
+            return "bool";
+        }
+        double d;
+        if (YAML::convert<double>::decode(n, d)) {
+            return "number";
+        }
+        return "string";
+    }
+
+    // Compare two documents, looking at the structure, and the type and value of each scalar.
+    void expect_same(const YAML::Node &a, const YAML::Node &b, const string &path) {
+        ASSERT_EQ(a.Type(), b.Type()) << path;
+        switch (a.Type()) {
+            case YAML::NodeType::Scalar:
+                ASSERT_EQ(scalar_kind(a), scalar_kind(b)) << path << ": " << a.Scalar() << " vs " << b.Scalar();
+                if (scalar_kind(a) == "bool") {
+                    EXPECT_EQ(a.as<bool>(), b.as<bool>()) << path;
+                } else if (scalar_kind(a) == "number") {
+                    EXPECT_EQ(a.as<double>(), b.as<double>()) << path;
+                } else {
+                    EXPECT_EQ(a.Scalar(), b.Scalar()) << path;
+                }
+                break;
+            case YAML::NodeType::Sequence:
+                ASSERT_EQ(a.size(), b.size()) << path;
+                for (size_t i = 0; i < a.size(); i++) {
+                    expect_same(a[i], b[i], path + "[" + to_string(i) + "]");
+                }
+                break;
+            case YAML::NodeType::Map:
+                ASSERT_EQ(a.size(), b.size()) << path;
+                for (auto &&item : a) {
+                    auto key = item.first.Scalar();
+                    ASSERT_TRUE(b[key]) << path << "." << key;
+                    expect_same(item.second, b[key], path + "." + key);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+TEST(t_json_spec_writer, same_as_yaml)
+{
+    ostringstream y_text, j_text;
+    yaml_spec_writer y_writer(y_text);
+    write_test_spec(y_writer, "../metadata/extra_metadata.yaml");
+    json_spec_writer j_writer(j_text);
+    write_test_spec(j_writer, "../metadata/extra_metadata.yaml");
+
+    auto y_doc = YAML::Load(y_text.str());
+    auto j_doc = YAML::Load(j_text.str());
+    expect_same(y_doc, j_doc, "");
+    EXPECT_TRUE(j_doc["metadata"]);
+}
+
+TEST(t_json_spec_writer, no_extra_metadata)
+{
+    ostringstream j_text;
+    json_spec_writer j_writer(j_text);
+    write_test_spec(j_writer, "no_such_file.yaml");
+
+    auto j_doc = YAML::Load(j_text.str());
+    EXPECT_EQ(j_doc["classes"].size(), 2);
+    EXPECT_FALSE(j_doc["metadata"]);
+}
+
+TEST(t_json_spec_writer, escape_string)
+{
+    ostringstream out;
+    write_json_string(out, "a\"b\\c\n\x01 é");
+    EXPECT_EQ(out.str(), "\"a\\\"b\\\\c\\n\\u0001 é\"");
+}
+
+TEST(t_json_spec_writer, yaml_scalars)
+{
+    auto node = YAML::Load("{a: 10, b: '10', c: True, d: ~, e: 1.5e3, f: 0x10, g: hi there, h: [1, \"x\"]}");
+    ostringstream out;
+    write_json(out, node);
+    EXPECT_EQ(out.str(), "{\"a\":10,\"b\":\"10\",\"c\":true,\"d\":null,\"e\":1.5e3,\"f\":\"0x10\",\"g\":\"hi there\",\"h\":[1,\"x\"]}");
+}
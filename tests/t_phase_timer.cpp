@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "phase_timer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(t_phase_timer, phases_in_order) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "first");
+    }
+    {
+        scoped_phase p(timer, "second");
+        this_thread::sleep_for(chrono::milliseconds(20));
+    }
+
+    ASSERT_EQ(timer.phases().size(), 2);
+    EXPECT_EQ(timer.phases()[0].name, "first");
+    EXPECT_EQ(timer.phases()[1].name, "second");
+    EXPECT_GE(timer.phases()[1].wall_seconds, 0.015);
+    EXPECT_GE(timer.total().wall_seconds, timer.phases()[1].wall_seconds);
+}
+
+TEST(t_phase_timer, cpu_time_counted) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "busy");
+        volatile double sum = 0;
+        auto start = chrono::steady_clock::now();
+        while (chrono::steady_clock::now() - start < chrono::milliseconds(50)) {
+            sum = sum + 1.0;
+        }
+    }
+    EXPECT_GT(timer.phases()[0].cpu_seconds, 0.0);
+}
+
+TEST(t_phase_timer, table) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "discovery");
+    }
+    ostringstream out;
+    write_phase_table(out, timer);
+
+    auto text = out.str();
+    EXPECT_NE(text.find("discovery"), string::npos);
+    EXPECT_NE(text.find("total"), string::npos);
+}
+
+TEST(t_phase_timer, json) {
+    phase_timer timer;
+    {
+        scoped_phase p(timer, "load \"libraries\"");
+    }
+    ostringstream out;
+    write_phase_json(out, timer);
+
+    auto doc = YAML::Load(out.str());
+    ASSERT_EQ(doc["phases"].size(), 1);
+    EXPECT_EQ(doc["phases"][0]["name"].as<string>(), "load \"libraries\"");
+    EXPECT_GE(doc["phases"][0]["wall_seconds"].as<double>(), 0.0);
+    EXPECT_GE(doc["total"]["cpu_seconds"].as<double>(), 0.0);
+}
+
+TEST(t_phase_timer, memory_sampled) {
+    phase_timer timer;
+    vector<char> big;
+    {
+        scoped_phase p(timer, "grow");
+        big.assign(64 * 1024 * 1024, 'x');
+    }
+
+    auto &&grow = timer.phases()[0];
+#ifdef __linux__
+    EXPECT_GT(grow.memory.rss_bytes, 64u * 1024 * 1024);
+    EXPECT_GT(grow.rss_change_bytes, 32 * 1024 * 1024);
+    EXPECT_GE(grow.memory.peak_rss_bytes, grow.memory.rss_bytes);
+#endif
+
+    ostringstream out;
+    write_phase_json(out, timer);
+    auto doc = YAML::Load(out.str());
+    EXPECT_EQ(doc["phases"][0]["rss_bytes"].as<uint64_t>(), grow.memory.rss_bytes);
+    EXPECT_TRUE(doc["total"]["peak_rss_bytes"].IsDefined());
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include "memory_reflection_provider.hpp"
+#include "translate.hpp"
+#include "type_helpers.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+using namespace std;
+
+namespace {
+    // A small jet class, enough to translate
+    shared_ptr<memory_reflection_provider> jet_provider() {
+        auto provider = make_shared<memory_reflection_provider>();
+
+        reflected_class base;
+        base.name = "xAOD::IParticle";
+        base.library = "libxAODBaseDict.so";
+        base.declaration_file = "xAODBase/IParticle.h";
+        provider->add_class(base);
+
+        reflected_class jet;
+        jet.name = "xAOD::Jet_v1";
+        jet.library = "libxAODJetDict.so";
+        jet.declaration_file = "xAODJet/versions/Jet_v1.h";
+        jet.public_bases.push_back("xAOD::IParticle");
+
+        method_info pt;
+        pt.name = "pt";
+        pt.return_type = "double";
+        pt.declaring_class = "xAOD::Jet_v1";
+        jet.methods.push_back(pt);
+
+        method_info setter;
+        setter.name = "setJetP4";
+        setter.return_type = "void";
+        setter.declaring_class = "xAOD::Jet_v1";
+        method_arg arg;
+        arg.raw_typename = "double";
+        arg.full_typename = "double";
+        setter.arguments.push_back(arg);
+        setter.arguments.push_back(arg);
+        arg.name = "from";
+        setter.arguments.push_back(arg);
+        jet.methods.push_back(setter);
+
+        method_info dtor;
+        dtor.name = "~Jet_v1";
+        jet.methods.push_back(dtor);
+
+        enum_info e;
+        e.name = "Kind";
+        e.values.push_back(make_pair("first", 0));
+        e.values.push_back(make_pair("second", 5));
+        jet.enums.push_back(e);
+        provider->add_class(jet);
+
+        provider->add_alias("xAOD::Jet", "xAOD::Jet_v1");
+        provider->add_typedef("xAOD::JetType", "xAOD::Jet_v1");
+        provider->add_include_file("xAODJet/versions/Jet_v1.h");
+        return provider;
+    }
+
+    // Use a provider for the length of a test
+    class use_provider {
+    public:
+        use_provider(shared_ptr<reflection_provider> p)
+            : m_old(set_reflection_provider(p))
+        {
+            clear_typedef_cache();
+        }
+        ~use_provider() {
+            set_reflection_provider(m_old);
+            clear_typedef_cache();
+        }
+    private:
+        shared_ptr<reflection_provider> m_old;
+    };
+}
+
+TEST(t_reflection_provider, class_name_lookup) {
+    auto provider = jet_provider();
+
+    EXPECT_EQ(provider->class_name("xAOD::Jet_v1"), "xAOD::Jet_v1");
+    EXPECT_EQ(provider->class_name("xAOD::Jet"), "xAOD::Jet_v1");
+    EXPECT_EQ(provider->class_name("xAOD::JetType"), "xAOD::Jet_v1");
+    EXPECT_EQ(provider->class_name("xAOD::Muon_v1"), "");
+    EXPECT_EQ(provider->class_name("__gnu_cxx::thing"), "");
+}
+
+TEST(t_reflection_provider, public_bases) {
+    auto provider = jet_provider();
+
+    auto bases = provider->public_bases("xAOD::Jet");
+    ASSERT_EQ(bases.size(), 1);
+    EXPECT_EQ(bases[0], "xAOD::IParticle");
+    EXPECT_EQ(provider->public_bases("xAOD::Muon_v1").size(), 0);
+}
+
+TEST(t_reflection_provider, class_library) {
+    auto provider = jet_provider();
+
+    EXPECT_EQ(provider->class_library("xAOD::Jet"), "libxAODJetDict.so");
+    EXPECT_EQ(provider->class_library("xAOD::Muon_v1"), "");
+}
+
+TEST(t_reflection_provider, unknown_class_is_empty) {
+    auto provider = jet_provider();
+    auto c = provider->get_class("xAOD::Muon_v1");
+    EXPECT_EQ(c.name, "");
+    EXPECT_EQ(c.methods.size(), 0);
+}
+
+TEST(t_reflection_provider, typedef_loop) {
+    memory_reflection_provider provider;
+    provider.add_typedef("A", "B");
+    provider.add_typedef("B", "A");
+    provider.add_typedef("C", "C");
+
+    EXPECT_EQ(provider.class_name("A"), "");
+    EXPECT_EQ(provider.class_name("C"), "");
+}
+
+TEST(t_reflection_provider, write_and_load) {
+    auto provider = jet_provider();
+
+    string path = "t_reflection_provider_round_trip.yaml";
+    {
+        ofstream out(path);
+        provider->write(out);
+    }
+    memory_reflection_provider loaded(path);
+    remove(path.c_str());
+
+    EXPECT_EQ(loaded.class_name("xAOD::Jet"), "xAOD::Jet_v1");
+    EXPECT_EQ(loaded.typedefs().at("xAOD::JetType"), "xAOD::Jet_v1");
+    EXPECT_TRUE(loaded.include_file_exists("xAODJet/versions/Jet_v1.h"));
+    EXPECT_FALSE(loaded.include_file_exists("xAODJet/JetContainer.h"));
+
+    auto jet = loaded.get_class("xAOD::Jet_v1");
+    EXPECT_EQ(jet.library, "libxAODJetDict.so");
+    EXPECT_EQ(jet.declaration_file, "xAODJet/versions/Jet_v1.h");
+    ASSERT_EQ(jet.methods.size(), 3);
+    EXPECT_EQ(jet.methods[1].arguments.size(), 3);
+    EXPECT_EQ(jet.methods[1].arguments[2].name, "from");
+    ASSERT_EQ(jet.enums.size(), 1);
+    EXPECT_EQ(jet.enums[0].values[1].second, 5);
+
+    // Writing it again gives the same thing
+    ostringstream first, second;
+    provider->write(first);
+    loaded.write(second);
+    EXPECT_EQ(first.str(), second.str());
+}
+
+TEST(t_reflection_provider, translate_class_from_memory) {
+    use_provider p(jet_provider());
+
+    auto info = translate_class("xAOD::Jet_v1");
+
+    EXPECT_EQ(info.name, "xAOD::Jet_v1");
+    EXPECT_EQ(info.library_name, "xAODJet");
+    EXPECT_EQ(info.include_file, "xAODJet/versions/Jet_v1.h");
+    ASSERT_EQ(info.inherited_class_names.size(), 1);
+    EXPECT_EQ(info.inherited_class_names[0], "xAOD::IParticle");
+
+    // Destructor is dropped, and the hand added getAttribute is there.
+    vector<string> names;
+    for (auto &&m : info.methods) {
+        names.push_back(m.name);
+    }
+    EXPECT_EQ(names, vector<string>({"pt", "setJetP4", "getAttribute"}));
+
+    auto &setter = info.methods[1];
+    EXPECT_EQ(setter.return_type, "");
+    ASSERT_EQ(setter.arguments.size(), 3);
+    EXPECT_EQ(setter.arguments[0].name, "noname_arg");
+    EXPECT_EQ(setter.arguments[1].name, "noname_arg_1");
+    EXPECT_EQ(setter.arguments[2].name, "from_arg");
+
+    ASSERT_EQ(info.enums.size(), 1);
+    EXPECT_EQ(info.enums[0].name, "Kind");
+}
+
+TEST(t_reflection_provider, unknown_class_not_translated) {
+    use_provider p(jet_provider());
+
+    auto info = translate_class("xAOD::Muon_v1");
+    EXPECT_EQ(info.name, "");
+}
+
+TEST(t_reflection_provider, recording_replays) {
+    auto recorder = make_shared<recording_reflection_provider>(jet_provider());
+    class_info original;
+    {
+        use_provider p(recorder);
+        original = translate_class("xAOD::Jet");
+    }
+
+    // Only what was looked at is recorded, and it is enough to do it again.
+    ostringstream recording;
+    recorder->recorded().write(recording);
+    string path = "t_reflection_provider_recording.yaml";
+    {
+        ofstream out(path);
+        out << recording.str();
+    }
+    auto replay = make_shared<memory_reflection_provider>(path);
+    remove(path.c_str());
+
+    EXPECT_EQ(replay->class_name("xAOD::Jet"), "xAOD::Jet_v1");
+    class_info replayed;
+    {
+        use_provider p(replay);
+        replayed = translate_class("xAOD::Jet");
+    }
+    EXPECT_EQ(replayed.name, original.name);
+    EXPECT_EQ(replayed.include_file, original.include_file);
+    EXPECT_EQ(replayed.methods.size(), original.methods.size());
+}
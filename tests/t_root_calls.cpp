@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "root_calls.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+
+using namespace std;
+
+TEST(t_root_calls, get_class_counted) {
+    auto start = read_root_call_totals();
+    root_get_class("TObject");
+    root_get_class("TObject");
+    auto diff = read_root_call_totals() - start;
+
+    EXPECT_EQ(diff[root_call::get_class].calls, 2);
+    EXPECT_GE(diff[root_call::get_class].seconds, 0.0);
+    EXPECT_EQ(diff[root_call::load].calls, 0);
+}
+
+TEST(t_root_calls, missing_file) {
+    auto start = read_root_call_totals();
+    EXPECT_FALSE(root_file_exists("/this/file/is/not/there.h"));
+    auto diff = read_root_call_totals() - start;
+    EXPECT_EQ(diff[root_call::access_path_name].calls, 1);
+}
+
+TEST(t_root_calls, table_lists_only_called) {
+    root_call_totals totals;
+    totals.values[static_cast<size_t>(root_call::get_class)].calls = 10;
+    totals.values[static_cast<size_t>(root_call::get_class)].seconds = 0.5;
+
+    ostringstream out;
+    write_root_call_table(out, totals);
+    EXPECT_NE(out.str().find("TClass::GetClass"), string::npos);
+    EXPECT_EQ(out.str().find("TSystem::Load"), string::npos);
+}
+
+TEST(t_root_calls, json) {
+    root_call_totals totals;
+    totals.values[static_cast<size_t>(root_call::load)].calls = 3;
+
+    ostringstream out;
+    write_root_call_json(out, totals);
+    auto doc = YAML::Load(out.str());
+    EXPECT_EQ(doc["TSystem::Load"]["calls"].as<int>(), 3);
+    EXPECT_EQ(doc.size(), static_cast<size_t>(root_call::n_calls));
+}
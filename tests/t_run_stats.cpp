@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "run_stats.hpp"
+#include "type_helpers.hpp"
+#include "memory_reflection_provider.hpp"
+#include "translate.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+
+using namespace std;
+
+TEST(t_run_stats, count_and_difference) {
+    auto start = read_run_counters();
+    add_count(run_counter::prune_passes);
+    add_count(run_counter::prune_passes, 2);
+    auto diff = read_run_counters() - start;
+
+    EXPECT_EQ(diff[run_counter::prune_passes], 3);
+    EXPECT_EQ(diff[run_counter::bytes_emitted], 0);
+}
+
+TEST(t_run_stats, parse_typename_counted) {
+    auto start = read_run_counters();
+    parse_typename("int");
+    auto diff = read_run_counters() - start;
+    EXPECT_GE(diff[run_counter::parse_typename_calls], 1);
+}
+
+TEST(t_run_stats, translate_counted) {
+    auto provider = make_shared<memory_reflection_provider>();
+    reflected_class c;
+    c.name = "xAOD::Thing_v1";
+    method_info m;
+    m.name = "pt";
+    m.return_type = "double";
+    c.methods.push_back(m);
+    m.name = "eta";
+    c.methods.push_back(m);
+    enum_info e;
+    e.name = "Kind";
+    c.enums.push_back(e);
+    provider->add_class(c);
+    auto old_provider = set_reflection_provider(provider);
+
+    auto start = read_run_counters();
+    translate_class("xAOD::Thing_v1");
+    auto diff = read_run_counters() - start;
+    set_reflection_provider(old_provider);
+
+    EXPECT_EQ(diff[run_counter::classes_translated], 1);
+    EXPECT_EQ(diff[run_counter::methods_translated], 2);
+    EXPECT_EQ(diff[run_counter::enums_translated], 1);
+}
+
+TEST(t_run_stats, counting_stream) {
+    ostringstream inner;
+    auto start = read_run_counters();
+    {
+        counting_ostream out(inner);
+        out << "hello" << 'x' << endl;
+    }
+    auto diff = read_run_counters() - start;
+
+    EXPECT_EQ(inner.str(), "hellox\n");
+    EXPECT_EQ(diff[run_counter::bytes_emitted], 7);
+}
+
+TEST(t_run_stats, counting_stream_past_buffer) {
+    ostringstream inner;
+    auto start = read_run_counters();
+    string block(100 * 1024 + 3, 'a');
+    {
+        counting_ostream out(inner);
+        out << block;
+        for (int i = 0; i < 70000; i++) {
+            out.put('b');
+        }
+        out.flush();
+        EXPECT_EQ(inner.str().size(), block.size() + 70000);
+    }
+    auto diff = read_run_counters() - start;
+
+    EXPECT_EQ(inner.str().size(), block.size() + 70000);
+    EXPECT_EQ(diff[run_counter::bytes_emitted], block.size() + 70000);
+}
+
+TEST(t_run_stats, reports) {
+    run_counters counters;
+    counters.values[static_cast<size_t>(run_counter::tclass_lookups)] = 42;
+
+    ostringstream text;
+    write_run_counters(text, counters);
+    EXPECT_NE(text.str().find("tclass_lookups"), string::npos);
+    EXPECT_NE(text.str().find("42"), string::npos);
+
+    ostringstream json;
+    write_run_counters_json(json, counters);
+    auto doc = YAML::Load(json.str());
+    EXPECT_EQ(doc["tclass_lookups"].as<int>(), 42);
+    EXPECT_EQ(doc["bytes_emitted"].as<int>(), 0);
+    EXPECT_EQ(doc.size(), static_cast<size_t>(run_counter::n_counters));
+}
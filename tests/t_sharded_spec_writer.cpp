@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "sharded_spec_writer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <filesystem>
+
+using namespace std;
+
+namespace {
+    spec_class make_class(const string &cpp_name, const string &python_name, const string &library) {
+        spec_class c;
+        c.cpp_name = cpp_name;
+        c.python_name = python_name;
+        c.library = library;
+        c.is_container = false;
+        return c;
+    }
+
+    // A jet that refers to a vertex, and a vector of jets.
+    void write_test_spec(spec_writer &writer) {
+        auto jet = make_class("xAOD::Jet_v1", "xAOD.Jet_v1", "xAODJet");
+        spec_method m;
+        m.name = "vertex";
+        m.return_type = "const xAOD::Vertex_v1*";
+        jet.methods.push_back(m);
+        jet.also_behaves_like = {"xAOD.IParticle"};
+
+        auto vertex = make_class("xAOD::Vertex_v1", "xAOD.Vertex_v1", "xAODTracking");
+        auto particle = make_class("xAOD::IParticle", "xAOD.IParticle", "xAODBase");
+
+        auto jets = make_class("vector<xAOD::Jet_v1*>", "vector[xAOD.Jet_v1]", "");
+        jets.is_container = true;
+        jets.is_container_of_cpp = "xAOD::Jet_v1*";
+        jets.is_container_of_python = "xAOD.Jet_v1";
+
+        auto floats = make_class("vector<float>", "vector[float]", "");
+
+        writer.write_collections({});
+        writer.begin_classes();
+        for (auto &&c : {jet, vertex, particle, jets, floats}) {
+            writer.write_class(c);
+        }
+        writer.end_classes();
+        writer.begin_files();
+        writer.write_file(spec_file{"trigger.py", {}, {"import os"}});
+        writer.end_files();
+        writer.write_config(spec_config{"22.2.107", {"PHYS"}});
+        writer.finish("../metadata/extra_metadata.yaml");
+    }
+
+    string clean_directory(const string &name) {
+        filesystem::remove_all(name);
+        return name;
+    }
+}
+
+TEST(t_sharded_spec_writer, shard_by_library)
+{
+    auto dir = clean_directory("sharded_by_library");
+    sharded_spec_writer writer(dir, spec_format::yaml, spec_shard_by::library);
+    write_test_spec(writer);
+
+    auto manifest = YAML::LoadFile(dir + "/manifest.yaml");
+    EXPECT_EQ(manifest["core"].as<string>(), "core.yaml");
+    EXPECT_EQ(manifest["classes"]["xAOD::Jet_v1"].as<string>(), "xAODJet");
+    EXPECT_EQ(manifest["classes"]["vector<xAOD::Jet_v1*>"].as<string>(), "xAOD");
+    EXPECT_EQ(manifest["classes"]["vector<float>"].as<string>(), "global");
+    ASSERT_EQ(manifest["shards"].size(), 5);
+
+    auto jet_shard = YAML::LoadFile(dir + "/xAODJet.yaml");
+    ASSERT_EQ(jet_shard["classes"].size(), 1);
+    EXPECT_EQ(jet_shard["classes"][0]["cpp_name"].as<string>(), "xAOD::Jet_v1");
+    EXPECT_EQ(jet_shard["config"]["atlas_release"].as<string>(), "22.2.107");
+
+    auto core = YAML::LoadFile(dir + "/core.yaml");
+    EXPECT_EQ(core["classes"].size(), 0);
+    EXPECT_EQ(core["files"].size(), 1);
+    EXPECT_TRUE(core["metadata"]);
+}
+
+TEST(t_sharded_spec_writer, shard_dependencies)
+{
+    auto dir = clean_directory("sharded_dependencies");
+    sharded_spec_writer writer(dir, spec_format::yaml, spec_shard_by::library);
+    write_test_spec(writer);
+
+    auto manifest = YAML::LoadFile(dir + "/manifest.yaml");
+    map<string, vector<string>> depends_on;
+    for (auto &&s : manifest["shards"]) {
+        depends_on[s["name"].as<string>()] = s["depends_on"].as<vector<string>>();
+    }
+    EXPECT_EQ(depends_on["xAODJet"], (vector<string>{"xAODBase", "xAODTracking"}));
+    EXPECT_EQ(depends_on["xAOD"], (vector<string>{"xAODJet"}));
+    EXPECT_EQ(depends_on["global"], (vector<string>{}));
+}
+
+TEST(t_sharded_spec_writer, shard_dependencies_from_arguments)
+{
+    auto dir = clean_directory("sharded_argument_dependencies");
+    sharded_spec_writer writer(dir, spec_format::yaml, spec_shard_by::library);
+
+    // The jet only refers to the vertex and the track through method arguments.
+    auto jet = make_class("xAOD::Jet_v1", "xAOD.Jet_v1", "xAODJet");
+    spec_method m;
+    m.name = "setVertex";
+    m.return_type = "void";
+    m.arguments = {spec_argument{"v", "xAOD.Vertex_v1"}};
+    jet.methods.push_back(m);
+    spec_method p;
+    p.name = "getTracks";
+    p.return_type = "bool";
+    p.parameter_arguments = {spec_argument{"tracks", "Iterable[xAOD.TrackParticle_v1]"}};
+    jet.methods.push_back(p);
+
+    auto vertex = make_class("xAOD::Vertex_v1", "xAOD.Vertex_v1", "xAODTracking");
+    auto track = make_class("xAOD::TrackParticle_v1", "xAOD.TrackParticle_v1", "xAODTrack");
+
+    writer.write_collections({});
+    writer.begin_classes();
+    for (auto &&c : {jet, vertex, track}) {
+        writer.write_class(c);
+    }
+    writer.end_classes();
+    writer.finish("");
+
+    auto manifest = YAML::LoadFile(dir + "/manifest.yaml");
+    map<string, vector<string>> depends_on;
+    for (auto &&s : manifest["shards"]) {
+        depends_on[s["name"].as<string>()] = s["depends_on"].as<vector<string>>();
+    }
+    EXPECT_EQ(depends_on["xAODJet"], (vector<string>{"xAODTrack", "xAODTracking"}));
+}
+
+TEST(t_sharded_spec_writer, shard_by_namespace_json)
+{
+    auto dir = clean_directory("sharded_by_namespace");
+    sharded_spec_writer writer(dir, spec_format::json, spec_shard_by::name_space);
+    write_test_spec(writer);
+
+    auto manifest = YAML::LoadFile(dir + "/manifest.json");
+    ASSERT_EQ(manifest["shards"].size(), 2);
+    EXPECT_EQ(manifest["classes"]["xAOD::Jet_v1"].as<string>(), "xAOD");
+    EXPECT_EQ(manifest["shards"][1]["classes"].as<int>(), 4);
+
+    auto xaod_shard = YAML::LoadFile(dir + "/xAOD.json");
+    EXPECT_EQ(xaod_shard["classes"].size(), 4);
+}
+
+TEST(t_sharded_spec_writer, compressed_shards)
+{
+    auto dir = clean_directory("sharded_compressed");
+    sharded_spec_writer writer(dir, spec_format::yaml, spec_shard_by::library, spec_compression::gzip, 2);
+    write_test_spec(writer);
+
+    auto manifest = YAML::LoadFile(dir + "/manifest.yaml");
+    EXPECT_EQ(manifest["core"].as<string>(), "core.yaml.gz");
+    EXPECT_TRUE(filesystem::exists(dir + "/xAODJet.yaml.gz"));
+    EXPECT_GT(writer.compression().bytes_in, writer.compression().bytes_out);
+}
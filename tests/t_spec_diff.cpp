@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "spec_diff.hpp"
+#include "yaml_spec_writer.hpp"
+#include "json_spec_writer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    spec_class make_class(const string &name, const vector<string> &methods) {
+        spec_class c;
+        c.python_name = name;
+        c.cpp_name = name;
+        c.is_container = false;
+        for (auto &&m_name : methods) {
+            spec_method m;
+            m.name = m_name;
+            m.return_type = "double";
+            c.methods.push_back(m);
+        }
+        return c;
+    }
+
+    // Write a spec with the given classes (already in canonical order) and files.
+    YAML::Node make_spec(const vector<spec_class> &classes, const vector<spec_file> &files, const string &release = "22.2.107") {
+        ostringstream out;
+        yaml_spec_writer writer(out);
+        writer.write_collections({});
+        writer.begin_classes();
+        for (auto &&c : classes) {
+            writer.write_class(c);
+        }
+        writer.end_classes();
+        writer.begin_files();
+        for (auto &&f : files) {
+            writer.write_file(f);
+        }
+        writer.end_files();
+        writer.write_config(spec_config{release, {"PHYS"}});
+        writer.finish("no_such_file.yaml");
+        return YAML::Load(out.str());
+    }
+
+    string as_json(const YAML::Node &node) {
+        ostringstream out;
+        write_json(out, node);
+        return out.str();
+    }
+}
+
+TEST(t_spec_diff, no_differences)
+{
+    auto spec = make_spec({make_class("a", {"pt"})}, {spec_file{"trigger.py", {}, {"import os"}}});
+    auto diff = diff_specs(spec, make_spec({make_class("a", {"pt"})}, {spec_file{"trigger.py", {}, {"import os"}}}));
+
+    EXPECT_TRUE(diff.empty());
+    ostringstream summary;
+    write_spec_diff_summary(summary, diff);
+    EXPECT_EQ(summary.str(), "No differences.\n");
+}
+
+TEST(t_spec_diff, classes_added_removed_changed)
+{
+    auto old_spec = make_spec({make_class("a", {"pt"}), make_class("b", {"eta"}), make_class("c", {"phi"})}, {});
+    auto new_spec = make_spec({make_class("a", {"pt"}), make_class("c", {"phi", "m"}), make_class("d", {})}, {});
+
+    auto diff = diff_specs(old_spec, new_spec);
+    ASSERT_EQ(diff.classes.added.size(), 1);
+    EXPECT_EQ(diff.classes.added[0]["cpp_name"].as<string>(), "d");
+    ASSERT_EQ(diff.classes.removed.size(), 1);
+    EXPECT_EQ(diff.classes.removed[0], "b");
+    ASSERT_EQ(diff.classes.changed.size(), 1);
+    EXPECT_EQ(diff.classes.changed[0].after["cpp_name"].as<string>(), "c");
+    EXPECT_TRUE(diff.collections.empty());
+    EXPECT_TRUE(diff.top_level_changed.empty());
+
+    ostringstream summary;
+    write_spec_diff_summary(summary, diff);
+    EXPECT_NE(summary.str().find("+ d"), string::npos);
+    EXPECT_NE(summary.str().find("- b"), string::npos);
+    EXPECT_NE(summary.str().find("+ m()"), string::npos);
+}
+
+TEST(t_spec_diff, config_changed)
+{
+    auto diff = diff_specs(make_spec({}, {}), make_spec({}, {}, "22.2.108"));
+    EXPECT_EQ(diff.top_level_changed.size(), 1);
+    EXPECT_EQ(diff.top_level_changed.count("config"), 1);
+}
+
+TEST(t_spec_diff, patch_rebuilds_new_spec)
+{
+    auto old_spec = make_spec({make_class("a", {"pt"}), make_class("b", {"eta"}), make_class("e", {})},
+        {spec_file{"one.py", {}, {"x = 1"}}, spec_file{"two.py", {}, {"y = 2"}}});
+    auto new_spec = make_spec({make_class("a", {"pt", "m"}), make_class("c", {}), make_class("e", {}), make_class("f", {})},
+        {spec_file{"two.py", {}, {"y = 3"}}, spec_file{"three.py", {}, {}}, spec_file{"one.py", {}, {"x = 1"}}},
+        "22.2.108");
+
+    // Go through the text of the patch, as the tool does
+    YAML::Emitter patch_text;
+    patch_text << spec_patch(diff_specs(old_spec, new_spec));
+    auto patch = YAML::Load(patch_text.c_str());
+
+    auto rebuilt = apply_spec_patch(old_spec, patch);
+    EXPECT_EQ(as_json(rebuilt), as_json(new_spec));
+    EXPECT_TRUE(diff_specs(rebuilt, new_spec).empty());
+}
+
+TEST(t_spec_diff, patch_must_fit)
+{
+    auto old_spec = make_spec({make_class("a", {})}, {});
+    old_spec["config"]["content_hash"] = "0123456789abcdef";
+    auto new_spec = make_spec({}, {});
+    new_spec["config"]["content_hash"] = "0123456789abcdef";
+    auto patch = spec_patch(diff_specs(old_spec, new_spec));
+
+    // Removing "a" from a spec without it.
+    EXPECT_THROW(apply_spec_patch(new_spec, patch), runtime_error);
+}
+
+TEST(t_spec_diff, patch_rebuilds_reordered_sections)
+{
+    // Classes out of name order in the new spec can not be merged back in by name.
+    auto old_spec = make_spec({make_class("a", {}), make_class("c", {})}, {});
+    auto new_spec = make_spec({make_class("c", {}), make_class("b", {}), make_class("a", {})}, {});
+
+    auto diff = diff_specs(old_spec, new_spec);
+    EXPECT_EQ(diff.classes.order, vector<string>({"c", "b", "a"}));
+    EXPECT_TRUE(diff.files.order.empty());
+
+    auto rebuilt = apply_spec_patch(old_spec, spec_patch(diff));
+    EXPECT_EQ(as_json(rebuilt), as_json(new_spec));
+}
+
+TEST(t_spec_diff, sorted_sections_need_no_order)
+{
+    auto old_spec = make_spec({make_class("a", {}), make_class("c", {})}, {});
+    auto new_spec = make_spec({make_class("a", {}), make_class("b", {}), make_class("c", {})}, {});
+
+    auto diff = diff_specs(old_spec, new_spec);
+    EXPECT_TRUE(diff.classes.order.empty());
+    EXPECT_FALSE(spec_patch(diff)["classes"]["order"]);
+}
+
+TEST(t_spec_diff, patch_checks_base_fingerprint)
+{
+    auto old_spec = make_spec({make_class("a", {})}, {});
+    auto new_spec = make_spec({make_class("b", {})}, {});
+    auto patch = spec_patch(diff_specs(old_spec, new_spec));
+    EXPECT_FALSE(patch["base_content_hash"]);
+    ASSERT_TRUE(patch["base_fingerprint"]);
+
+    EXPECT_NO_THROW(apply_spec_patch(make_spec({make_class("a", {})}, {}), patch));
+    EXPECT_THROW(apply_spec_patch(make_spec({make_class("a", {"pt"})}, {}), patch), runtime_error);
+
+    patch.remove("base_fingerprint");
+    EXPECT_THROW(apply_spec_patch(old_spec, patch), runtime_error);
+}
+
+TEST(t_spec_diff, patch_checks_base_hash)
+{
+    auto old_spec = make_spec({make_class("a", {})}, {});
+    old_spec["config"]["content_hash"] = "0123456789abcdef";
+    auto new_spec = make_spec({make_class("b", {})}, {});
+    auto patch = spec_patch(diff_specs(old_spec, new_spec));
+    EXPECT_EQ(patch["base_content_hash"].as<string>(), "0123456789abcdef");
+
+    auto other = make_spec({make_class("a", {})}, {});
+    other["config"]["content_hash"] = "fedcba9876543210";
+    EXPECT_THROW(apply_spec_patch(other, patch), runtime_error);
+}
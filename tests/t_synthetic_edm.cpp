@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "synthetic_edm.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+    string read_file(const fs::path &path) {
+        ifstream in(path);
+        stringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+    size_t count_of(const string &text, const string &what) {
+        size_t n = 0;
+        for (auto pos = text.find(what); pos != string::npos; pos = text.find(what, pos + 1)) {
+            n++;
+        }
+        return n;
+    }
+}
+
+TEST(t_synthetic_edm, header_names)
+{
+    synthetic_edm_config config;
+    config.n_classes = 1001;
+    config.classes_per_header = 500;
+    auto headers = synthetic_edm_headers(config);
+    ASSERT_EQ(headers.size(), 5);
+    EXPECT_EQ(headers[0], "SyntheticEDM/Common.h");
+    EXPECT_EQ(headers[3], "SyntheticEDM/Classes2.h");
+    EXPECT_EQ(headers[4], "SyntheticEDM/Event.h");
+}
+
+TEST(t_synthetic_edm, writes_all_classes)
+{
+    synthetic_edm_config config;
+    config.n_classes = 25;
+    config.classes_per_header = 10;
+    config.inheritance_depth = 3;
+    config.template_depth = 4;
+    config.enums_per_class = 2;
+
+    fs::remove_all("synthetic_edm_small");
+    write_synthetic_edm(config, "synthetic_edm_small");
+
+    for (auto &&h : synthetic_edm_headers(config)) {
+        EXPECT_TRUE(fs::exists(fs::path("synthetic_edm_small") / h)) << h;
+    }
+
+    string classes;
+    for (int i = 0; i < 3; i++) {
+        classes += read_file("synthetic_edm_small/SyntheticEDM/Classes" + to_string(i) + ".h");
+    }
+    EXPECT_EQ(count_of(classes, "    class Class"), 25 + 24);  // definitions and forward declarations
+    EXPECT_EQ(count_of(classes, "enum Kind"), 25 * 2);
+    EXPECT_NE(classes.find("class Class3_v1 : public Base3_2 {"), string::npos);
+    EXPECT_NE(classes.find("std::vector<std::vector<std::vector<std::vector<float> > > > nested()"), string::npos);
+    EXPECT_NE(classes.find("ElementLink<DataVector<synthetic::Class8_v1> > link8()"), string::npos);
+
+    auto common = read_file("synthetic_edm_small/SyntheticEDM/Common.h");
+    EXPECT_NE(common.find("class Base9_2 : public Base9_1 {"), string::npos);
+
+    auto linkdef = read_file("synthetic_edm_small/LinkDef.h");
+    EXPECT_EQ(count_of(linkdef, "#pragma link C++ class DataVector<synthetic::"), 25);
+    EXPECT_NE(linkdef.find("#pragma link C++ class synthetic::Class24_v1+;"), string::npos);
+    EXPECT_NE(linkdef.find("#pragma link C++ class synthetic::Event_v1+;"), string::npos);
+
+    fs::remove_all("synthetic_edm_small");
+}
+
+TEST(t_synthetic_edm, bad_config)
+{
+    synthetic_edm_config config;
+    config.classes_per_header = 0;
+    EXPECT_THROW(write_synthetic_edm(config, "synthetic_edm_bad"), runtime_error);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "trace.hpp"
+#include "phase_timer.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    // Trace to a recorder for the length of a test
+    class use_trace {
+    public:
+        use_trace(trace_recorder &trace)
+            : m_old(set_active_trace(&trace))
+        {}
+        ~use_trace() {
+            set_active_trace(m_old);
+        }
+    private:
+        trace_recorder *m_old;
+    };
+}
+
+TEST(t_trace, off_by_default) {
+    EXPECT_EQ(active_trace(), nullptr);
+    scoped_trace_span span("nothing", "test", "detail");
+}
+
+TEST(t_trace, nested_spans) {
+    trace_recorder trace;
+    {
+        use_trace t(trace);
+        scoped_trace_span outer("outer", "test");
+        {
+            scoped_trace_span inner("inner", "test", "xAOD::Jet_v1");
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    }
+
+    auto events = trace.events();
+    ASSERT_EQ(events.size(), 2);
+
+    // Inner finishes first
+    EXPECT_EQ(events[0].name, "inner");
+    EXPECT_EQ(events[0].detail, "xAOD::Jet_v1");
+    EXPECT_EQ(events[1].name, "outer");
+    EXPECT_LE(events[1].start_us, events[0].start_us);
+    EXPECT_GE(events[1].start_us + events[1].duration_us, events[0].start_us + events[0].duration_us);
+    EXPECT_EQ(events[0].thread, 0);
+}
+
+TEST(t_trace, not_recorded_after_stop) {
+    trace_recorder trace;
+    {
+        use_trace t(trace);
+    }
+    scoped_trace_span span("late", "test");
+    EXPECT_EQ(trace.events().size(), 0);
+}
+
+TEST(t_trace, threads_numbered) {
+    trace_recorder trace;
+    {
+        use_trace t(trace);
+        thread worker([]() { scoped_trace_span span("work", "test"); });
+        worker.join();
+    }
+    auto events = trace.events();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].thread, 1);
+}
+
+TEST(t_trace, phases_are_spans) {
+    trace_recorder trace;
+    phase_timer timer;
+    {
+        use_trace t(trace);
+        scoped_phase p(timer, "discovery");
+    }
+    auto events = trace.events();
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].name, "discovery");
+    EXPECT_EQ(events[0].category, "phase");
+}
+
+TEST(t_trace, write_json) {
+    trace_recorder trace;
+    {
+        use_trace t(trace);
+        scoped_trace_span span("translate_class", "translate", "DataVector<xAOD::Jet_v1>");
+    }
+    ostringstream out;
+    trace.write(out);
+
+    auto doc = YAML::Load(out.str());
+    auto events = doc["traceEvents"];
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0]["ph"].as<string>(), "M");
+    EXPECT_EQ(events[1]["ph"].as<string>(), "X");
+    EXPECT_EQ(events[1]["name"].as<string>(), "translate_class");
+    EXPECT_EQ(events[1]["args"]["detail"].as<string>(), "DataVector<xAOD::Jet_v1>");
+    EXPECT_GE(events[1]["dur"].as<double>(), 0.0);
+}
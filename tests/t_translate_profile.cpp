@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "translate_profile.hpp"
+#include "memory_reflection_provider.hpp"
+#include "translate.hpp"
+#include "type_helpers.hpp"
+
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    class_translate_timing timing(const string &name, double lookup, double methods) {
+        class_translate_timing t;
+        t.name = name;
+        t.lookup_seconds = lookup;
+        t.methods_seconds = methods;
+        return t;
+    }
+
+    // Profile class translations for the length of a test
+    class use_profile {
+    public:
+        use_profile(translate_profile &profile)
+            : m_old(set_active_translate_profile(&profile))
+        {}
+        ~use_profile() {
+            set_active_translate_profile(m_old);
+        }
+    private:
+        translate_profile *m_old;
+    };
+}
+
+TEST(t_translate_profile, slowest_first) {
+    translate_profile profile;
+    profile.add(timing("a", 0.001, 0.0));
+    profile.add(timing("b", 0.010, 0.5));
+    profile.add(timing("c", 0.100, 0.0));
+
+    auto slow = profile.slowest(2);
+    ASSERT_EQ(slow.size(), 2);
+    EXPECT_EQ(slow[0].name, "b");
+    EXPECT_EQ(slow[1].name, "c");
+
+    EXPECT_EQ(profile.slowest(10).size(), 3);
+}
+
+TEST(t_translate_profile, stopwatch_off) {
+    ASSERT_EQ(active_translate_profile(), nullptr);
+    class_translate_stopwatch s("xAOD::Jet_v1");
+    s.lap(&class_translate_timing::methods_seconds);
+}
+
+TEST(t_translate_profile, stopwatch_laps) {
+    translate_profile profile;
+    {
+        use_profile p(profile);
+        class_translate_stopwatch s("xAOD::Jet_v1");
+        s.lap(&class_translate_timing::methods_seconds);
+        s.lap(&class_translate_timing::include_seconds);
+    }
+    auto all = profile.classes();
+    ASSERT_EQ(all.size(), 1);
+    EXPECT_EQ(all[0].name, "xAOD::Jet_v1");
+    EXPECT_GE(all[0].methods_seconds, 0.0);
+    EXPECT_GE(all[0].total_seconds(), all[0].methods_seconds);
+}
+
+TEST(t_translate_profile, translate_class_reports) {
+    auto provider = make_shared<memory_reflection_provider>();
+    reflected_class c;
+    c.name = "xAOD::Thing_v1";
+    method_info m;
+    m.name = "pt";
+    m.return_type = "double";
+    c.methods.push_back(m);
+    provider->add_class(c);
+
+    auto old_provider = set_reflection_provider(provider);
+    translate_profile profile;
+    {
+        use_profile p(profile);
+        translate_class("xAOD::Thing_v1");
+        translate_class("xAOD::NotThere_v1");
+    }
+    set_reflection_provider(old_provider);
+
+    auto all = profile.classes();
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_EQ(all[0].name, "xAOD::Thing_v1");
+    EXPECT_EQ(all[1].name, "xAOD::NotThere_v1");
+    EXPECT_EQ(all[1].methods_seconds, 0.0);
+}
+
+TEST(t_translate_profile, reports) {
+    translate_profile profile;
+    profile.add(timing("fast", 5e-6, 0.0));
+    profile.add(timing("medium", 2e-3, 0.0));
+    profile.add(timing("slow", 4.0, 1.0));
+
+    ostringstream histogram;
+    write_translate_histogram(histogram, profile);
+    EXPECT_NE(histogram.str().find("3 classes translated"), string::npos);
+    EXPECT_NE(histogram.str().find(">= 3 s"), string::npos);
+
+    ostringstream slow;
+    write_slowest_classes(slow, profile, 1);
+    EXPECT_NE(slow.str().find("slow"), string::npos);
+    EXPECT_EQ(slow.str().find("medium"), string::npos);
+}
+
+TEST(t_translate_profile, empty_histogram) {
+    translate_profile profile;
+    ostringstream histogram;
+    write_translate_histogram(histogram, profile);
+    EXPECT_NE(histogram.str().find("0 classes translated"), string::npos);
+}
@@ -540,6 +540,35 @@ TEST(t_type_helpers, container_of_vector) {
     EXPECT_EQ(t.cpp_name, "int");
 }
 
+TEST(t_type_helpers, try_container_of_simple_class) {
+    class_info ci;
+    ci.name = "dude";
+    ci.name_as_type = parse_typename("dude");
+
+    typename_info t;
+    string why;
+    EXPECT_EQ(try_container_of(ci, t, &why), false);
+    EXPECT_NE(why.find("dude"), string::npos);
+}
+
+TEST(t_type_helpers, classify_containers) {
+    class_info ci_vector;
+    ci_vector.name = "vector<int>";
+    ci_vector.name_as_type = parse_typename("vector<int>");
+
+    class_info ci_simple;
+    ci_simple.name = "dude";
+    ci_simple.name_as_type = parse_typename("dude");
+
+    vector<class_info> classes({ci_vector, ci_simple});
+    classify_containers(classes);
+
+    EXPECT_EQ(classes[0].is_container, true);
+    EXPECT_EQ(classes[0].container_type.cpp_name, "int");
+    EXPECT_EQ(classes[1].is_container, false);
+    EXPECT_EQ(classes[1].container_type.cpp_name, "");
+}
+
 TEST(t_type_helpers, cpp_string_simple) {
     EXPECT_EQ(typename_cpp_string(parse_typename("int")), "int");
 }
@@ -652,6 +681,90 @@ TEST(t_type_helpers, understood_method_template) {
     EXPECT_EQ(is_understood_method(m, set<string>({"int"})), true);
 }
 
+TEST(t_type_helpers, understood_method_template_not_leaked) {
+    method_info m_template;
+    m_template.name = "fork";
+    m_template.return_type = "U";
+
+    method_arg ma;
+    ma.name = "return_type";
+    ma.raw_typename = "cpp_type<U>";
+    ma.full_typename = "cpp_type<U>";
+    m_template.parameter_arguments.push_back(ma);
+
+    method_info m_plain;
+    m_plain.name = "spoon";
+    m_plain.return_type = "U";
+
+    // The cpp_type argument should only make `U` known for the method that declares it.
+    set<string> known({"int"});
+    understood_type_cache cache(known);
+    EXPECT_EQ(is_understood_method(m_template, cache), true);
+    EXPECT_EQ(is_understood_method(m_plain, cache), false);
+    EXPECT_EQ(known.size(), 1);
+}
+
+TEST(t_type_helpers, understood_type_cache_verdicts) {
+    set<string> known({"int", "vector<int>"});
+    understood_type_cache cache(known);
+
+    EXPECT_EQ(cache.is_understood("int"), true);
+    EXPECT_EQ(cache.is_understood("const int *"), true);
+    EXPECT_EQ(cache.is_understood("vector<int>"), true);
+    EXPECT_EQ(cache.is_understood("float"), false);
+    EXPECT_EQ(cache.unqualified_name("const int *"), "int");
+}
+
+TEST(t_type_helpers, understood_type_cache_reset) {
+    set<string> known_1({"int"});
+    set<string> known_2({"float"});
+    understood_type_cache cache(known_1);
+
+    EXPECT_EQ(cache.is_understood("float"), false);
+    auto v = cache.version();
+
+    cache.reset(known_2);
+    EXPECT_NE(cache.version(), v);
+    EXPECT_EQ(cache.is_understood("float"), true);
+    EXPECT_EQ(cache.is_understood("int"), false);
+}
+
+TEST(t_type_helpers, fundamental_types) {
+    EXPECT_EQ(is_fundamental_type("unsigned char"), true);
+    EXPECT_EQ(is_fundamental_type("xAOD::Jet_v1"), false);
+}
+
+TEST(t_type_helpers, in_namespaces_simple) {
+    set<string> ns({"xAOD"});
+    EXPECT_EQ(type_in_namespaces(parse_typename("xAOD::Jet_v1"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("ROOT::Math::PtEtaPhiM4D<double>"), ns), false);
+    EXPECT_EQ(type_in_namespaces(parse_typename("const xAOD::Jet_v1*"), ns), true);
+}
+
+TEST(t_type_helpers, in_namespaces_global) {
+    set<string> ns({"xAOD"});
+    EXPECT_EQ(type_in_namespaces(parse_typename("TObject"), ns), false);
+    EXPECT_EQ(type_in_namespaces(parse_typename("float"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("TObject"), set<string>({"xAOD", "::"})), true);
+}
+
+TEST(t_type_helpers, in_namespaces_namespace_itself) {
+    set<string> ns({"xAOD"});
+    EXPECT_EQ(type_in_namespaces(parse_typename("xAOD"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("xAOD::Type"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("ROOT"), ns), false);
+}
+
+TEST(t_type_helpers, in_namespaces_global_templates) {
+    set<string> ns({"xAOD"});
+    EXPECT_EQ(type_in_namespaces(parse_typename("vector<float>"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("DataVector<xAOD::Jet_v1>"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("ElementLink<DataVector<xAOD::Jet_v1>>"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("DataVector<xAOD::Jet_v1>::iterator"), ns), true);
+    EXPECT_EQ(type_in_namespaces(parse_typename("vector<TObject>"), ns), false);
+    EXPECT_EQ(type_in_namespaces(parse_typename("xAOD::Vec<int>::size_type"), ns), true);
+}
+
 TEST(t_type_helpers, py_type_simple_type) {
     auto t = py_typename("int");
     EXPECT_EQ(t.type_name, "int");
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include "yaml_spec_writer.hpp"
+#include "helper_files.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+#include <sstream>
+#include <fstream>
+
+using namespace std;
+
+namespace {
+    spec_class simple_class() {
+        spec_class c;
+        c.python_name = "xAOD.Jet_v1";
+        c.cpp_name = "xAOD::Jet_v1";
+        c.library = "xAODJet";
+        c.is_container = false;
+        c.include_file = "xAODJet/versions/Jet_v1.h";
+
+        spec_method m;
+        m.name = "pt";
+        m.return_type = "double";
+        c.methods.push_back(m);
+        return c;
+    }
+
+    // Write a full spec with one class and no files
+    string write_simple_spec(const vector<spec_class> &classes) {
+        ostringstream out;
+        yaml_spec_writer writer(out);
+        writer.write_collections({});
+        writer.begin_classes();
+        for (auto &&c : classes) {
+            writer.write_class(c);
+        }
+        writer.end_classes();
+        writer.begin_files();
+        writer.end_files();
+        writer.write_config(spec_config{"22.2.107", {"PHYS", "PHYSLITE"}});
+        writer.finish("no_such_file.yaml");
+        return out.str();
+    }
+}
+
+TEST(t_yaml_spec_writer, class_round_trip)
+{
+    auto text = write_simple_spec({simple_class()});
+    auto doc = YAML::Load(text);
+
+    ASSERT_EQ(doc["classes"].size(), 1);
+    auto c = doc["classes"][0];
+    EXPECT_EQ(c["python_name"].as<string>(), "xAOD.Jet_v1");
+    EXPECT_EQ(c["cpp_name"].as<string>(), "xAOD::Jet_v1");
+    EXPECT_EQ(c["library"].as<string>(), "xAODJet");
+    EXPECT_FALSE(c["is_container_of_cpp"]);
+    EXPECT_EQ(c["methods"][0]["name"].as<string>(), "pt");
+    EXPECT_FALSE(c["methods"][0]["arguments"]);
+    EXPECT_FALSE(c["inherits_from"]);
+}
+
+TEST(t_yaml_spec_writer, declared_methods_only)
+{
+    auto c = simple_class();
+    c.inherits_from = {"xAOD::IParticle"};
+
+    ostringstream out;
+    yaml_spec_writer writer(out);
+    writer.begin_classes();
+    writer.write_class(c);
+    writer.end_classes();
+    writer.write_config(spec_config{"22.2.107", {"PHYS"}, true});
+    writer.finish("no_such_file.yaml");
+
+    auto doc = YAML::Load(out.str());
+    EXPECT_EQ(doc["classes"][0]["inherits_from"][0].as<string>(), "xAOD::IParticle");
+    EXPECT_TRUE(doc["config"]["declared_methods_only"].as<bool>());
+}
+
+TEST(t_yaml_spec_writer, empty_pieces)
+{
+    auto text = write_simple_spec({});
+    auto doc = YAML::Load(text);
+
+    EXPECT_EQ(doc["collections"].size(), 0);
+    EXPECT_FALSE(doc["files"]);
+    EXPECT_EQ(doc["config"]["atlas_release"].as<string>(), "22.2.107");
+    EXPECT_EQ(doc["config"]["dataset_types"].size(), 2);
+}
+
+TEST(t_yaml_spec_writer, collection_default_parameter)
+{
+    spec_collection c;
+    c.collection_name = "Jets";
+    c.cpp_item_type = "xAOD::Jet_v1";
+    c.python_item_type = "xAOD.Jet_v1";
+    c.cpp_container_type = "DataVector<xAOD::Jet_v1>";
+    c.python_container_type = "Iterable[xAOD.Jet_v1]";
+    c.include_file = "xAODJet/JetContainer.h";
+    c.link_libraries = {"xAODJet"};
+    c.has_metadata = false;
+
+    ostringstream out;
+    yaml_spec_writer writer(out);
+    writer.write_collections({c});
+    writer.finish("no_such_file.yaml");
+
+    auto doc = YAML::Load(out.str());
+    auto params = doc["collections"][0]["parameters"];
+    ASSERT_EQ(params.size(), 1);
+    EXPECT_EQ(params[0]["name"].as<string>(), "name");
+    EXPECT_EQ(params[0]["type"].as<string>(), "str");
+}
+
+TEST(t_yaml_spec_writer, file_contents)
+{
+    ostringstream out;
+    yaml_spec_writer writer(out);
+    writer.begin_files();
+    writer.write_file(spec_file{"trigger.py", {"from .trigger import tdt_chain_fired"}, {"import os", "x = 'hi: there'"}});
+    writer.end_files();
+    writer.finish("no_such_file.yaml");
+
+    auto doc = YAML::Load(out.str());
+    ASSERT_EQ(doc["files"].size(), 1);
+    EXPECT_EQ(doc["files"][0]["name"].as<string>(), "trigger.py");
+    EXPECT_EQ(doc["files"][0]["contents"][1].as<string>(), "x = 'hi: there'");
+}
+
+TEST(t_yaml_spec_writer, file_as_text)
+{
+    // A real metadata file, which has blank lines, indents, quotes, etc.
+    vector<string> lines;
+    ifstream in("../metadata/trigger.py");
+    string line;
+    while (getline(in, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        lines.push_back(line);
+    }
+    ASSERT_GT(lines.size(), 0);
+
+    spec_file f{"trigger.py", {"from .trigger import tdt_chain_fired"}, lines};
+    f.as_text = true;
+    f.content_hash = helper_file_hash(lines);
+
+    ostringstream out;
+    yaml_spec_writer writer(out);
+    writer.begin_files();
+    writer.write_file(f);
+    writer.end_files();
+    writer.finish("no_such_file.yaml");
+
+    auto doc = YAML::Load(out.str());
+    auto file = doc["files"][0];
+    EXPECT_FALSE(file["contents"]);
+    EXPECT_EQ(file["text"].as<string>(), helper_file_text(lines));
+    EXPECT_EQ(file["content_hash"].as<string>(), f.content_hash);
+    EXPECT_EQ(file["init_lines"][0].as<string>(), "from .trigger import tdt_chain_fired");
+}
+
+TEST(t_yaml_spec_writer, file_reference)
+{
+    spec_file f{"trigger.py", {}, {"import os"}};
+    f.as_text = true;
+    f.content_hash = helper_file_hash(f.contents);
+    f.reference = "base.yaml";
+
+    ostringstream out;
+    yaml_spec_writer writer(out);
+    writer.begin_files();
+    writer.write_file(f);
+    writer.end_files();
+    writer.finish("no_such_file.yaml");
+
+    auto doc = YAML::Load(out.str());
+    auto file = doc["files"][0];
+    EXPECT_FALSE(file["text"]);
+    EXPECT_FALSE(file["contents"]);
+    EXPECT_EQ(file["reference"].as<string>(), "base.yaml");
+    EXPECT_EQ(file["content_hash"].as<string>(), f.content_hash);
+}
+
+TEST(t_yaml_spec_writer, spec_file_hashes)
+{
+    // The hash must not depend on how the file was written in the reference spec, even
+    // when it ends in blank lines.
+    vector<string> lines{"import os", "", "  x = 1", "", ""};
+    {
+        ofstream ref("ref_spec_files.yaml");
+        yaml_spec_writer writer(ref);
+        writer.begin_files();
+        writer.write_file(spec_file{"lines.py", {}, lines});
+        spec_file text{"text.py", {}, lines};
+        text.as_text = true;
+        text.content_hash = helper_file_hash(lines);
+        writer.write_file(text);
+        writer.end_files();
+        writer.finish("no_such_file.yaml");
+    }
+
+    auto hashes = spec_file_hashes("ref_spec_files.yaml");
+    auto id = spec_reference_id("ref_spec_files.yaml");
+    remove("ref_spec_files.yaml");
+    ASSERT_EQ(hashes.size(), 2);
+    EXPECT_EQ(hashes["lines.py"], helper_file_hash(lines));
+    EXPECT_EQ(hashes["text.py"], helper_file_hash(lines));
+    EXPECT_EQ(id, "ref_spec_files.yaml");
+}
+
+TEST(t_yaml_spec_writer, spec_file_hashes_text_without_hash)
+{
+    // A text block reads back without the blank lines the file ended with
+    {
+        ofstream ref("ref_spec_text.yaml");
+        ref << "files:" << endl
+            << "  - name: text.py" << endl
+            << "    init_lines: []" << endl
+            << "    text: |" << endl
+            << "      import os" << endl
+            << "" << endl
+            << "        x = 1" << endl;
+    }
+
+    auto hashes = spec_file_hashes("ref_spec_text.yaml");
+    remove("ref_spec_text.yaml");
+    EXPECT_EQ(hashes["text.py"], helper_file_hash({"import os", "", "  x = 1", "", ""}));
+}
+
+TEST(t_yaml_spec_writer, spec_reference_id_content_hash)
+{
+    {
+        ofstream ref("ref_spec_hash.yaml");
+        spec_config config{"22.2.107", {"PHYS"}, false};
+        config.content_hash = "0123456789abcdef";
+        yaml_spec_writer writer(ref);
+        writer.write_config(config);
+        writer.finish("no_such_file.yaml");
+    }
+
+    auto id = spec_reference_id("ref_spec_hash.yaml");
+    remove("ref_spec_hash.yaml");
+    EXPECT_EQ(id, "0123456789abcdef");
+}